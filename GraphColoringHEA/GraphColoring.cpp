@@ -3,29 +3,72 @@
 using namespace std;
 
 
+mutex GraphColoring::randSeedMutex;
+
+
 ///=== [ solving procedure ] ===============================
 
 GraphColoring::GraphColoring( const AdjVertexList &avl, int cn )
     : MAX_CONFLICT( avl.size() * avl.size() ), vertexNum( avl.size() ), colorNum( cn ),
-    adjVertexList( avl ), population(), optima( MAX_CONFLICT ),
-    iterCount( 0 ), generationCount( 0 ), timer()
+    adjVertexList( avl ), solutionPool(), spareSolutions(), population(), localOptimaBuffer( 0 ),
+    optima( MAX_CONFLICT ), isGraphModified( false ), lowerBound( 0 ),
+    cancelFlag( 0 ), timeLimit( 0 ), startTime( chrono::steady_clock::now() ),
+    iterCount( 0 ), generationCount( 0 ), timer(), randSeed( 0 ),
+    PERTURB_TYPE( RANDOM_RECOLOR ), PERTURB_STRENGTH( 0 )
 {
+    lock_guard<mutex> lock( randSeedMutex );
     Random::setSeed();
+    randSeed = Random::getSeed();
+}
+
+void GraphColoring::setRandSeed( int seed )
+{
+    lock_guard<mutex> lock( randSeedMutex );
+    Random::setSeed( seed );
+    randSeed = seed;
 }
 
+void GraphColoring::reset( const AdjVertexList &avl, int cn )
+{
+    vertexNum = static_cast<int>(avl.size());
+    colorNum = cn;
+    MAX_CONFLICT = vertexNum * vertexNum;
+
+    // assign each row to keep its capacity
+    adjVertexList.resize( vertexNum );
+    for (int v = 0; v < vertexNum; v++) {
+        adjVertexList[v].assign( avl[v].begin(), avl[v].end() );
+    }
+
+    clearPopulation();
+    optima.conflictEdgeNum = MAX_CONFLICT;
+    optima.vertexColor.clear();
+    initVertexColor.clear();
+    isGraphModified = false;
+    lowerBound = 0;
+
+    iterCount = 0;
+    generationCount = 0;
+}
 
 void GraphColoring::init( int tabuTenureBase, int tabuTenureAmp,
     int maxGenerationCount, int maxIterCount,
-    int populationSize, int mutateIndividualNum )
+    int populationSize, int mutateIndividualNum,
+    double poolQualityWeight, int tabuTenureAdaptPeriod,
+    LocalSearchType localSearchType )
 {
     timer.reset();
+    startTime = chrono::steady_clock::now();
 
     POPULATION_SIZE = populationSize;
     MAX_GENERATION_COUNT = maxGenerationCount;
     MAX_ITERATION_COUNT = maxIterCount;
     TABU_TENURE_BASE = tabuTenureBase;
     TABU_TENURE_AMP = tabuTenureAmp;
+    TABU_TENURE_ADAPT_PERIOD = tabuTenureAdaptPeriod;
     MUTATE_INDIVIDUAL_NUM = mutateIndividualNum;
+    POOL_QUALITY_WEIGHT = poolQualityWeight;
+    LOCAL_SEARCH_TYPE = localSearchType;
 
     ostringstream ss;
     ss << "HEA(PS=" << POPULATION_SIZE
@@ -33,30 +76,68 @@ void GraphColoring::init( int tabuTenureBase, int tabuTenureAmp,
         << "|IC=" << MAX_ITERATION_COUNT
         << "|TB=" << TABU_TENURE_BASE
         << "|TA=" << TABU_TENURE_AMP
+        << "|TP=" << TABU_TENURE_ADAPT_PERIOD
         << "|MN=" << MUTATE_INDIVIDUAL_NUM
+        << "|QW=" << POOL_QUALITY_WEIGHT
+        << "|LS=" << ((LOCAL_SEARCH_TYPE == PARTIAL_COL) ? "PartialCol" : "TabuCol")
         << ')';
     SOLVING_ALGORITHM = ss.str();
 
+    // the new population is generated on the current graph
+    clearPopulation();
+    isGraphModified = false;
+
+    // no legal coloring exists
+    if (isInfeasible()) {
+        return;
+    }
 
     genInitPopulation( POPULATION_SIZE );
 }
 
 void GraphColoring::solve()
 {
+    if (isInfeasible()) {
+        timer.record();
+        return;
+    }
+
+    if (isGraphModified) {
+        repairPopulation();
+    }
+
+    // init() stops at the first legal coloring, so the population may be too small to select two parents
+    int minPopulationSize = max( 2, POPULATION_SIZE );
+    if ((optima.conflictEdgeNum > 0) && (static_cast<int>(population.size()) < minPopulationSize)) {
+        genInitPopulation( minPopulationSize - population.size() );
+    }
+
     if (optima.conflictEdgeNum > 0) {   // in case the optima is found in init()
         for (; generationCount < MAX_GENERATION_COUNT; generationCount++) {
+            if (progressCallback) {
+                progressCallback( Progress( generationCount, iterCount,
+                    optima.conflictEdgeNum, getElapsedTime() ) );
+            }
+            if (isStopped() || (optima.conflictEdgeNum <= 0)  // the callback may immigrate the optima
+                || (population.size() < 2)) {   // stopped while filling the population
+                break;
+            }
+
             // select parents
             VertexSet parentSet( selectParents() );
 
             // combine
-            Solution offspring( combineParents( parentSet ) );
+            Solution *offspring = combineParents( parentSet );
 
-            // local search on offspring
-            //iterCount += offspring.localSearch();
-            iterCount += offspring.tabuSearch();
+            // cheap descent on offspring before the expensive local search
+            iterCount += offspring->localSearch();
+            if (offspring->evaluate() > 0) {
+                iterCount += searchSolution( *offspring );
+            }
 
             // update optima and check if there is no conflict
-            if (updateOptima( offspring )) {
+            if (updateOptima( *offspring )) {
+                deleteSolution( offspring );
                 break;
             }
 
@@ -72,14 +153,175 @@ void GraphColoring::solve()
 }
 
 
+bool GraphColoring::immigrate( const VertexColor &vertexColor )
+{
+    if ((static_cast<int>(vertexColor.size()) != vertexNum) || population.empty()) {
+        return false;
+    }
+
+    Solution *immigrant = newSolution( fixColorAssign( vertexColor, vertexNum, colorNum ) );
+    if (updateOptima( *immigrant )) {
+        deleteSolution( immigrant );
+        return true;
+    }
+    if (updatePopulation( immigrant )) {
+        mutateIndividuals( MUTATE_INDIVIDUAL_NUM );
+    }
+
+    return false;
+}
+
+int GraphColoring::computeLowerBound( const AdjVertexList &adjVertexList, double exactTimeLimit )
+{
+    MaxClique maxClique;
+    return computeLowerBound( maxClique, adjVertexList, exactTimeLimit );
+}
+
+int GraphColoring::computeLowerBound( MaxClique &maxClique, const AdjVertexList &adjVertexList, double exactTimeLimit )
+{
+    maxClique.reset( adjVertexList );
+    maxClique.greedySearch();
+    if (exactTimeLimit > 0) {
+        maxClique.exactSearch( exactTimeLimit );
+    }
+
+    return maxClique.getCliqueSize();
+}
+
+bool GraphColoring::isOptimal() const
+{
+    return ((optima.conflictEdgeNum == 0) && (getUsedColorNum() <= lowerBound));
+}
+
+int GraphColoring::getUsedColorNum() const
+{
+    vector<bool> isUsed( colorNum, false );
+    for (VertexColor::const_iterator iter = optima.vertexColor.begin();
+        iter != optima.vertexColor.end(); iter++) {
+        isUsed[*iter] = true;
+    }
+
+    return static_cast<int>(count( isUsed.begin(), isUsed.end(), true ));
+}
+
+void GraphColoring::loadSolution( const Output &sln )
+{
+    initVertexColor = sln.vertexColor;
+}
+
+bool GraphColoring::insertEdge( int v1, int v2 )
+{
+    if (!isValidVertex( v1 ) || !isValidVertex( v2 )) {
+        return false;
+    }
+    AdjVertex &av1( adjVertexList[v1] );
+    if ((v1 == v2) || (find( av1.begin(), av1.end(), v2 ) != av1.end())) {
+        return false;
+    }
+
+    av1.push_back( v2 );
+    adjVertexList[v2].push_back( v1 );
+
+    for (size_t i = 0; i < population.size(); i++) {
+        population[i]->insertEdge( v1, v2 );
+    }
+    if (!optima.vertexColor.empty() && (optima.vertexColor[v1] == optima.vertexColor[v2])) {   // init() is called
+        optima.conflictEdgeNum++;
+    }
+
+    isGraphModified = true;
+    return true;
+}
+
+bool GraphColoring::removeEdge( int v1, int v2 )
+{
+    if (!isValidVertex( v1 ) || !isValidVertex( v2 )) {
+        return false;
+    }
+    AdjVertex &av1( adjVertexList[v1] );
+    AdjVertex &av2( adjVertexList[v2] );
+    AdjVertex::iterator iter1 = find( av1.begin(), av1.end(), v2 );
+    if (iter1 == av1.end()) {
+        return false;
+    }
+    AdjVertex::iterator iter2 = find( av2.begin(), av2.end(), v1 );
+
+    // the order of adjacent vertices does not matter
+    *iter1 = av1.back();
+    av1.pop_back();
+    *iter2 = av2.back();
+    av2.pop_back();
+
+    // the clique may be broken
+    lowerBound = 0;
+
+    for (size_t i = 0; i < population.size(); i++) {
+        population[i]->removeEdge( v1, v2 );
+    }
+    if (!optima.vertexColor.empty() && (optima.vertexColor[v1] == optima.vertexColor[v2])) {   // init() is called
+        optima.conflictEdgeNum--;
+    }
+
+    isGraphModified = true;
+    return true;
+}
+
+void GraphColoring::repairPopulation()
+{
+    isGraphModified = false;
+    timer.reset();
+    startTime = chrono::steady_clock::now();
+    iterCount = 0;
+    generationCount = 0;
+    if (population.empty()) {   // init() is not called
+        return;
+    }
+
+    // the previous optima may not be in the population
+    int best = 0;
+    for (int i = 1; i < static_cast<int>(population.size()); i++) {
+        if (*population[i] < *population[best]) {
+            best = i;
+        }
+    }
+    if (optima.conflictEdgeNum < population[best]->evaluate()) {
+        addIndividual( newSolution( optima.vertexColor ) );
+        best = population.size() - 1;
+    }
+
+    optima = Output( MAX_CONFLICT );
+    unsigned oldHash = population[best]->hash();
+    iterCount += searchSolution( *population[best] );
+    updateIndividual( best, oldHash );
+    for (size_t i = 0; i < population.size(); i++) {
+        updateOptima( *population[i] );
+    }
+}
+
+bool GraphColoring::isStopped() const
+{
+    return ((cancelFlag && cancelFlag->load( memory_order_relaxed ))
+        || ((timeLimit > 0) && (getElapsedTime() >= timeLimit)));
+}
+
+double GraphColoring::getElapsedTime() const
+{
+    return chrono::duration<double>( chrono::steady_clock::now() - startTime ).count();
+}
+
 void GraphColoring::genInitPopulation( int size )
 {
-    while (size--) {
-        Solution s( this, genRandomColorAssign( vertexNum, colorNum ) );
-        iterCount += s.tabuSearch();
-        //iterCount += s.localSearch();
-        population.push_back( s );
-        if (updateOptima( s )) {
+    while (size-- && !isStopped()) {
+        Solution *s = newSolution( (initVertexColor.empty()
+            ? genRandomColorAssign( vertexNum, colorNum )
+            : fixColorAssign( initVertexColor, vertexNum, colorNum )) );
+        initVertexColor.clear();    // only the first individual is loaded
+        iterCount += s->localSearch();
+        if (s->evaluate() > 0) {
+            iterCount += searchSolution( *s );
+        }
+        addIndividual( s );
+        if (updateOptima( *s )) {
             return;
         }
     }
@@ -94,10 +336,10 @@ GraphColoring::SolutionIndexSet GraphColoring::selectParents()
     // then select one of the best individuals as second parent
     RandSelect rs;
     int parent2 = ((parent1 == 0) ? 1 : 0);
-    int minConflict = population[parent2].evaluate();
+    int minConflict = population[parent2]->evaluate();
     for (int i = parent2 + 1; i < static_cast<int>(population.size()); i++) {
         if (i != parent1) {
-            int conflict = population[i].evaluate();
+            int conflict = population[i]->evaluate();
             if (conflict < minConflict) {
                 parent2 = i;
                 minConflict = conflict;
@@ -118,14 +360,14 @@ GraphColoring::SolutionIndexSet GraphColoring::selectParents()
     return parents;
 }
 
-GraphColoring::Solution GraphColoring::combineParents( const VertexSet &parents )
+GraphColoring::Solution* GraphColoring::combineParents( const VertexSet &parents )
 {
     vector<ColorVertex> pcv( parents.size() );
 
     int i = 0;
     for (VertexSet::const_iterator iter = parents.begin();
         iter != parents.end(); iter++, i++) {
-        pcv[i] = population[*iter];
+        pcv[i] = *population[*iter];
     }
 
     VertexColor vc( vertexNum );
@@ -179,7 +421,7 @@ GraphColoring::Solution GraphColoring::combineParents( const VertexSet &parents
         }
     }
 
-    return Solution( this, vc );
+    return newSolution( vc );
 }
 
 bool GraphColoring::updateOptima( const Solution &sln )
@@ -190,31 +432,27 @@ bool GraphColoring::updateOptima( const Solution &sln )
     return (optima.conflictEdgeNum <= 0);
 }
 
-bool GraphColoring::updatePopulation( const Solution &offspring )
+bool GraphColoring::updatePopulation( Solution *offspring )
 {
-    // select one of the worst individuals to drop
-    RandSelect rs;
-    int worstSln = 0;
-    for (int i = 1; i < static_cast<int>(population.size()); i++) {
-        if (population[worstSln] < population[i]) {
-            worstSln = i;
-            rs.reset();
-        } else if ((population[worstSln] == population[i])
-            && (rs.isSelected())) {
-            worstSln = i;
-        }
+    // reject the offspring which is already in the population
+    vector<int> distance;
+    if (isDuplicate( *offspring, distance )) {
+        deleteSolution( offspring );
+        return false;
     }
 
-    // replace old or just add the offspring
-    if (offspring < population[worstSln]) {
-        population[worstSln] = offspring;
-    } else if (population.size() < static_cast<size_t>(2 * POPULATION_SIZE)) {
-        population.push_back( offspring );
-    } else {    // cull excess bad individuals
-        sort( population.begin(), population.end() );
-        //population.resize( POPULATION_SIZE ); // need default constructor which is dangerous
+    addIndividual( offspring, distance );
+
+    // drop the worst individual or just keep the offspring
+    int worstSln = selectWorstIndividual();
+    int offspringIndex = population.size() - 1;
+    if (worstSln != offspringIndex) {
+        removeIndividual( worstSln );
+    } else if (population.size() > static_cast<size_t>(2 * POPULATION_SIZE)) {
+        // cull excess bad individuals
+        removeIndividual( offspringIndex );
         while (static_cast<int>(population.size()) > POPULATION_SIZE) {
-            population.pop_back();
+            removeIndividual( selectWorstIndividual() );
         }
         return true;
     }
@@ -228,6 +466,8 @@ void GraphColoring::mutateIndividuals( int mutateIndividualNum )
     RangeRand rr( 0, population.size() - 1 );
     set<int> mutatedIndividuals;
 
+    // each individual is mutated at most once
+    mutateIndividualNum = min( mutateIndividualNum, static_cast<int>(population.size()) );
     while (mutateIndividualNum--) {
         int individual;
         do {
@@ -235,8 +475,192 @@ void GraphColoring::mutateIndividuals( int mutateIndividualNum )
         } while (mutatedIndividuals.find( individual ) != mutatedIndividuals.end());
         mutatedIndividuals.insert( individual );
 
-        population[individual].perturb();
+        unsigned oldHash = population[individual]->hash();
+        population[individual]->perturb( PERTURB_TYPE, PERTURB_STRENGTH );
+        updateIndividual( individual, oldHash );
+    }
+}
+
+GraphColoring::Solution* GraphColoring::newSolution( const VertexColor &vc )
+{
+    if (spareSolutions.empty()) {
+        solutionPool.push_back( Solution( this, vc ) );
+        return &solutionPool.back();
+    }
+
+    Solution *sln = spareSolutions.back();
+    spareSolutions.pop_back();
+    sln->assign( vc );
+    return sln;
+}
+
+GraphColoring::Solution* GraphColoring::newSolution( const Solution &s )
+{
+    if (spareSolutions.empty()) {
+        solutionPool.push_back( s );
+        return &solutionPool.back();
+    }
+
+    Solution *sln = spareSolutions.back();
+    spareSolutions.pop_back();
+    *sln = s;
+    return sln;
+}
+
+void GraphColoring::clearPopulation()
+{
+    population.clear();
+    populationDistance.clear();
+    populationHash.clear();
+
+    localOptimaBuffer = 0;
+    spareSolutions.clear();
+    for (deque<Solution>::iterator iter = solutionPool.begin(); iter != solutionPool.end(); iter++) {
+        spareSolutions.push_back( &(*iter) );
+    }
+}
+
+int GraphColoring::searchSolution( Solution &sln )
+{
+    if (localOptimaBuffer == 0) {
+        localOptimaBuffer = newSolution( sln );
+    }
+    return sln.search( *localOptimaBuffer );
+}
+
+void GraphColoring::addIndividual( Solution *sln )
+{
+    vector<int> distance( population.size() );
+    for (size_t i = 0; i < population.size(); i++) {
+        distance[i] = sln->distance( *population[i] );
     }
+    addIndividual( sln, distance );
+}
+
+void GraphColoring::addIndividual( Solution *sln, const vector<int> &distance )
+{
+    int index = population.size();
+    population.push_back( sln );
+    populationHash.insert( sln->hash() );
+
+    populationDistance.push_back( distance );
+    populationDistance[index].push_back( 0 );
+    for (int i = 0; i < index; i++) {
+        populationDistance[i].push_back( distance[i] );
+    }
+}
+
+void GraphColoring::removeIndividual( int index )
+{
+    populationHash.erase( populationHash.find( population[index]->hash() ) );
+    deleteSolution( population[index] );
+
+    // move the last individual to the index to avoid shifting the rest
+    int last = population.size() - 1;
+    if (index != last) {
+        population[index] = population[last];
+        populationDistance[index].swap( populationDistance[last] );
+        for (int i = 0; i < last; i++) {
+            populationDistance[i][index] = populationDistance[i][last];
+        }
+        populationDistance[index][index] = 0;
+    }
+
+    population.pop_back();
+    populationDistance.pop_back();
+    for (int i = 0; i < last; i++) {
+        populationDistance[i].pop_back();
+    }
+}
+
+void GraphColoring::updateIndividual( int index, unsigned oldHash )
+{
+    populationHash.erase( populationHash.find( oldHash ) );
+    populationHash.insert( population[index]->hash() );
+    updateIndividualDistance( index );
+}
+
+void GraphColoring::updateIndividualDistance( int index )
+{
+    for (int i = 0; i < static_cast<int>(population.size()); i++) {
+        if (i != index) {
+            int d = population[index]->distance( *population[i] );
+            populationDistance[index][i] = d;
+            populationDistance[i][index] = d;
+        }
+    }
+}
+
+bool GraphColoring::isDuplicate( const Solution &sln, vector<int> &distance ) const
+{
+    // check hash first to reject exact duplicates without computing distance
+    if (populationHash.find( sln.hash() ) != populationHash.end()) {
+        for (size_t i = 0; i < population.size(); i++) {
+            if (sln.isSameAssign( *population[i] )) {
+                return true;
+            }
+        }
+    }
+
+    // same partition with permuted colors
+    distance.resize( population.size() );
+    for (size_t i = 0; i < population.size(); i++) {
+        distance[i] = sln.distance( *population[i] );
+        if (distance[i] == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int GraphColoring::selectWorstIndividual() const
+{
+    int size = population.size();
+    if (size < 2) {
+        return 0;
+    }
+
+    // the distance from an individual to the population is the distance to the closest one
+    vector<int> distance( size, vertexNum );
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            if ((i != j) && (populationDistance[i][j] < distance[i])) {
+                distance[i] = populationDistance[i][j];
+            }
+        }
+    }
+
+    int minConflict = population[0]->evaluate();
+    int maxConflict = minConflict;
+    int minDistance = distance[0];
+    int maxDistance = minDistance;
+    for (int i = 1; i < size; i++) {
+        minConflict = min( minConflict, population[i]->evaluate() );
+        maxConflict = max( maxConflict, population[i]->evaluate() );
+        minDistance = min( minDistance, distance[i] );
+        maxDistance = max( maxDistance, distance[i] );
+    }
+
+    // goodness score with normalized conflict and distance (the larger is the better)
+    RandSelect rs;
+    int worstSln = 0;
+    double minScore = 2;
+    for (int i = 0; i < size; i++) {
+        double score = POOL_QUALITY_WEIGHT
+            * (maxConflict - population[i]->evaluate()) / (maxConflict - minConflict + 1)
+            + (1 - POOL_QUALITY_WEIGHT)
+            * (distance[i] - minDistance) / (maxDistance - minDistance + 1);
+        if (score < minScore) {
+            worstSln = i;
+            minScore = score;
+            rs.reset();
+        } else if ((score == minScore) && rs.isSelected()) {
+            worstSln = i;
+        }
+    }
+
+    return worstSln;
 }
 
 GraphColoring::VertexColor GraphColoring::genRandomColorAssign( int vertexNum, int colorNum )
@@ -250,11 +674,23 @@ GraphColoring::VertexColor GraphColoring::genRandomColorAssign( int vertexNum, i
     return vc;
 }
 
+GraphColoring::VertexColor GraphColoring::fixColorAssign( const VertexColor &vc, int vertexNum, int colorNum )
+{
+    VertexColor fixedColor( genRandomColorAssign( vertexNum, colorNum ) );
+    for (int vertex = min( vertexNum, static_cast<int>(vc.size()) ) - 1; vertex >= 0; vertex--) {
+        if ((vc[vertex] >= 0) && (vc[vertex] < colorNum)) {
+            fixedColor[vertex] = vc[vertex];
+        }
+    }
+
+    return fixedColor;
+}
+
 ///=== [ Solution ] ===============================
 
 GraphColoring::Solution::Solution( const GraphColoring *pgc, const VertexColor &vc )
     : gc( pgc ), conflictEdgeNum( 0 ), conflictVertices( pgc->vertexNum ),
-    vertexColor( vc ), adjColorTab(), tabu()
+    vertexColor( vc ), colorHash( 0 ), adjColorTab(), tabu()
 {
     initDataStructure();
 }
@@ -262,17 +698,21 @@ GraphColoring::Solution::Solution( const GraphColoring *pgc, const VertexColor &
 void GraphColoring::Solution::initDataStructure()
 {
     conflictEdgeNum = 0;
-    adjColorTab = AdjColorTable( gc->vertexNum, vector<int>( gc->colorNum, 0 ) );
-    tabu = AdjColorTable( gc->vertexNum, vector<int>( gc->colorNum, 0 ) );
+    colorHash = 0;
     conflictVertices.clear();
 
-    for (size_t vertex = 0; vertex < adjColorTab.size(); vertex++) {
-        AdjColor &adjColor = adjColorTab[vertex];
+    // reuse the allocated tables
+    adjColorTab.assign( tableSize(), 0 );
+    tabu.assign( tableSize(), 0 );
+
+    for (int vertex = 0; vertex < gc->vertexNum; vertex++) {
+        int *adjColor = &adjColorTab[rowOf( vertex )];
         const AdjVertex &adjVertex = gc->adjVertexList[vertex];
         for (size_t adj = 0; adj < adjVertex.size(); adj++) {
             adjColor[vertexColor[adjVertex[adj]]]++;
         }
         conflictEdgeNum += adjColor[vertexColor[vertex]];
+        colorHash ^= vertexColorHash( vertex, vertexColor[vertex] );
         if (adjColor[vertexColor[vertex]] > 0) {
             conflictVertices.insert( vertex );
         }
@@ -282,8 +722,8 @@ void GraphColoring::Solution::initDataStructure()
 
 GraphColoring::Solution::Solution( const Solution &s )
     :gc( s.gc ), conflictEdgeNum( s.conflictEdgeNum ), conflictVertices( s.conflictVertices ),
-    vertexColor( s.vertexColor ), adjColorTab( s.adjColorTab ),
-    tabu( gc->vertexNum, vector<int>( gc->colorNum, 0 ) )
+    vertexColor( s.vertexColor ), colorHash( s.colorHash ), adjColorTab( s.adjColorTab ),
+    tabu( tableSize(), 0 )
 {
 }
 
@@ -293,11 +733,22 @@ GraphColoring::Solution& GraphColoring::Solution::operator=(const Solution &s)
     conflictVertices = s.conflictVertices;
     conflictEdgeNum = s.conflictEdgeNum;
     vertexColor = s.vertexColor;
+    colorHash = s.colorHash;
     adjColorTab = s.adjColorTab;
-    tabu = AdjColorTable( gc->vertexNum, vector<int>( gc->colorNum, 0 ) );
+    tabu.assign( tableSize(), 0 );
     return *this;
 }
 
+void GraphColoring::Solution::assign( const VertexColor &vc )
+{
+    // the index can not grow, so it is only rebuilt for a larger graph
+    if (vertexColor.size() < vc.size()) {
+        conflictVertices = BidirectionIndex( gc->vertexNum );
+    }
+    vertexColor = vc;
+    initDataStructure();
+}
+
 int GraphColoring::Solution::localSearch()
 {
     RandSelect maxReduceSelect;
@@ -306,20 +757,19 @@ int GraphColoring::Solution::localSearch()
     for (; iterCount < gc->MAX_ITERATION_COUNT; iterCount++) {
         ConflictReduce maxReduce( 0 );  // positive value if improved
 
-        // find best conflictEdgeNum reduction
-        for (size_t v = 0; v < adjColorTab.size(); v++) {
+        // for each vertex with conflictEdgeNum, find best conflictEdgeNum reduction
+        for (int i = 0; i < conflictVertices.size(); i++) {
+            int v = conflictVertices.elementAt( i );
             int color = vertexColor[v];
-            AdjColor &ac = adjColorTab[v];
-            if (ac[color] > 0) {    // for each vertex with conflictEdgeNum
-                for (int c = 0; c < gc->colorNum; c++) {
-                    if (c != color) {  // for each destination color
-                        int reduce = ac[color] - ac[c];
-                        if (reduce > maxReduce.reduce) {
-                            maxReduce = ConflictReduce( reduce, static_cast<int>(v), c );
-                            maxReduceSelect.reset();
-                        } else if ((reduce == maxReduce.reduce) && maxReduceSelect.isSelected()) {
-                            maxReduce = ConflictReduce( reduce, static_cast<int>(v), c );
-                        }
+            const int *ac = &adjColorTab[rowOf( v )];
+            for (int c = 0; c < gc->colorNum; c++) {
+                if (c != color) {  // for each destination color
+                    int reduce = ac[color] - ac[c];
+                    if (reduce > maxReduce.reduce) {
+                        maxReduce = ConflictReduce( reduce, v, c );
+                        maxReduceSelect.reset();
+                    } else if ((reduce == maxReduce.reduce) && maxReduceSelect.isSelected()) {
+                        maxReduce = ConflictReduce( reduce, v, c );
                     }
                 }
             }
@@ -330,31 +780,63 @@ int GraphColoring::Solution::localSearch()
             break;
         }
 
-        // apply the conflictEdgeNum reduction
-        conflictEdgeNum -= maxReduce.reduce;
-        int srcColor = vertexColor[maxReduce.vertex];
-        vertexColor[maxReduce.vertex] = maxReduce.desColor;
-        const AdjVertex &av = gc->adjVertexList[maxReduce.vertex];
-        for (AdjVertex::const_iterator iter = av.begin();
-            iter != av.end(); iter++) {
-            adjColorTab[*iter][srcColor]--;
-            adjColorTab[*iter][maxReduce.desColor]++;
-        }
+        applyMove( maxReduce.vertex, maxReduce.desColor );
     }
 
     return iterCount;
 }
 
-int GraphColoring::Solution::tabuSearch()
+void GraphColoring::Solution::applyMove( int vertex, Color desColor )
 {
-    Solution localOptima( *this );
+    int srcColor = vertexColor[vertex];
+    const int *adjColor = &adjColorTab[rowOf( vertex )];
+    conflictEdgeNum += (adjColor[desColor] - adjColor[srcColor]);
+    vertexColor[vertex] = desColor;
+    colorHash ^= (vertexColorHash( vertex, srcColor ) ^ vertexColorHash( vertex, desColor ));
+
+    // update neighbors
+    const AdjVertex &av = gc->adjVertexList[vertex];
+    for (AdjVertex::const_iterator iter = av.begin(); iter != av.end(); iter++) {
+        int *ac = &adjColorTab[rowOf( *iter )];
+        int c = vertexColor[*iter];
+        if ((--ac[srcColor] == 0) && (c == srcColor)) {
+            conflictVertices.eraseElement( *iter );
+        }
+        if ((++ac[desColor] == 1) && (c == desColor)) {
+            conflictVertices.insert( *iter );
+        }
+    }
+
+    // update the vertex itself
+    bool wasConflict = (adjColor[srcColor] > 0);
+    bool isConflict = (adjColor[desColor] > 0);
+    if (wasConflict && !isConflict) {
+        conflictVertices.eraseElement( vertex );
+    } else if (!wasConflict && isConflict) {
+        conflictVertices.insert( vertex );
+    }
+}
+
+int GraphColoring::Solution::tabuSearch( Solution &localOptima )
+{
+    localOptima = *this;
 
     RandSelect maxReduceSelectT;
     RandSelect maxReduceSelectNT;
     RangeRand tabuTenurePerturb( 0, gc->TABU_TENURE_AMP );
 
+    // reactive tenure amplitude which is enlarged on stagnation
+    int tabuTenureAmp = gc->TABU_TENURE_AMP;
+    const int enlargedTabuTenureAmp = gc->TABU_TENURE_AMP + gc->TABU_TENURE_AMP / 4 + 1;
+    int stagnationIterCount = 0;
+
     int iterCount = 1;
     for (; iterCount < gc->MAX_ITERATION_COUNT; iterCount++) {
+        // check the stop condition periodically to reduce the overhead
+        if (((iterCount & STOP_CHECK_INTERVAL_MASK) == 0) && gc->isStopped()) {
+            break;
+        }
+
         // positive value if improved
         ConflictReduce maxReduceT( -gc->MAX_CONFLICT );     // for tabu
         ConflictReduce maxReduceNT( -gc->MAX_CONFLICT );    // for none-tabu
@@ -363,11 +845,12 @@ int GraphColoring::Solution::tabuSearch()
         for (int i = 0; i < conflictVertices.size(); i++) {
             int v = conflictVertices.elementAt( i );
             int color = vertexColor[v];
-            AdjColor &ac = adjColorTab[v];
+            const int *ac = &adjColorTab[rowOf( v )];
+            const int *tabuColor = &tabu[rowOf( v )];
             for (int c = 0; c < gc->colorNum; c++) {
                 if (c != color) {  // for each destination color
                     int reduce = ac[color] - ac[c];
-                    if (tabu[v][c] < iterCount) {
+                    if (tabuColor[c] < iterCount) {
                         if (reduce > maxReduceNT.reduce) {
                             maxReduceNT = ConflictReduce( reduce, v, c );
                             maxReduceSelectNT.reset();
@@ -395,30 +878,11 @@ int GraphColoring::Solution::tabuSearch()
 
         if (maxReduce.reduce != -gc->MAX_CONFLICT) {    // there is valid move
             // apply the conflictEdgeNum reduction
-            conflictEdgeNum -= maxReduce.reduce;
             int srcColor = vertexColor[maxReduce.vertex];
-            vertexColor[maxReduce.vertex] = maxReduce.desColor;
-            const AdjVertex &av = gc->adjVertexList[maxReduce.vertex];
-            for (AdjVertex::const_iterator iter = av.begin();
-                iter != av.end(); iter++) {
-                adjColorTab[*iter][srcColor]--;
-                int c = vertexColor[*iter];
-                if ((c == srcColor)
-                    && adjColorTab[*iter][c] <= 0) {
-                    conflictVertices.eraseElement( *iter );
-                } else if ((c == maxReduce.desColor)
-                    && (adjColorTab[*iter][c] <= 0)) {
-                    conflictVertices.insert( *iter );
-                }
-                adjColorTab[*iter][maxReduce.desColor]++;
-            }
-            if ((adjColorTab[maxReduce.vertex][maxReduce.desColor] <= 0)
-                && (adjColorTab[maxReduce.vertex][srcColor] > 0)) {
-                conflictVertices.eraseElement( maxReduce.vertex );
-            } // a non-conflict vertex won't be searched, so no else
+            applyMove( maxReduce.vertex, maxReduce.desColor );
 
             // update tabu list
-            tabu[maxReduce.vertex][srcColor] = iterCount + conflictEdgeNum + gc->TABU_TENURE_BASE + tabuTenurePerturb();
+            tabu[rowOf( maxReduce.vertex ) + srcColor] = iterCount + conflictEdgeNum + gc->TABU_TENURE_BASE + tabuTenurePerturb();
 
             // update local optima
             if (localOptima.conflictEdgeNum > conflictEdgeNum) {
@@ -426,8 +890,23 @@ int GraphColoring::Solution::tabuSearch()
                 if (conflictEdgeNum <= 0) {
                     break;
                 }
+                stagnationIterCount = 0;
+                if (tabuTenureAmp > gc->TABU_TENURE_AMP) {
+                    tabuTenureAmp = gc->TABU_TENURE_AMP;
+                    tabuTenurePerturb = RangeRand( 0, tabuTenureAmp );
+                }
             }
         }
+
+        // enlarge the tabu tenure to escape from the current region,
+        // or drop back if the enlarged one did not help either
+        if ((gc->TABU_TENURE_ADAPT_PERIOD > 0)
+            && (++stagnationIterCount >= gc->TABU_TENURE_ADAPT_PERIOD)) {
+            stagnationIterCount = 0;
+            tabuTenureAmp = ((tabuTenureAmp > gc->TABU_TENURE_AMP)
+                ? gc->TABU_TENURE_AMP : enlargedTabuTenureAmp);
+            tabuTenurePerturb = RangeRand( 0, tabuTenureAmp );
+        }
     }
 
 
@@ -437,18 +916,361 @@ int GraphColoring::Solution::tabuSearch()
     return iterCount;
 }
 
-void GraphColoring::Solution::perturb()
+int GraphColoring::Solution::search( Solution &localOptima )
+{
+    switch (gc->LOCAL_SEARCH_TYPE) {
+        case PARTIAL_COL:
+            return partialColSearch( localOptima );
+        default:
+            return tabuSearch( localOptima );
+    }
+}
+
+int GraphColoring::Solution::partialColSearch( Solution &localOptima )
+{
+    BidirectionIndex uncoloredVertices( gc->vertexNum );
+    uncolorConflictVertices( uncoloredVertices );
+    localOptima = *this;
+    int minUncoloredNum = uncoloredVertices.size();
+
+    RandSelect maxReduceSelectT;
+    RandSelect maxReduceSelectNT;
+    RangeRand tabuTenurePerturb( 0, gc->TABU_TENURE_AMP );
+
+    int iterCount = 1;
+    for (; (iterCount < gc->MAX_ITERATION_COUNT) && (minUncoloredNum > 0); iterCount++) {
+        // check the stop condition periodically to reduce the overhead
+        if (((iterCount & STOP_CHECK_INTERVAL_MASK) == 0) && gc->isStopped()) {
+            break;
+        }
+
+        // positive value if improved
+        ConflictReduce maxReduceT( -gc->MAX_CONFLICT );     // for tabu
+        ConflictReduce maxReduceNT( -gc->MAX_CONFLICT );    // for none-tabu
+
+        // for each uncolored vertex, find the color class with the least neighbors to uncolor
+        for (int i = 0; i < uncoloredVertices.size(); i++) {
+            int v = uncoloredVertices.elementAt( i );
+            const int *ac = &adjColorTab[rowOf( v )];
+            const int *tabuColor = &tabu[rowOf( v )];
+            for (int c = 0; c < gc->colorNum; c++) {
+                int reduce = 1 - ac[c];
+                if (tabuColor[c] < iterCount) {
+                    if (reduce > maxReduceNT.reduce) {
+                        maxReduceNT = ConflictReduce( reduce, v, c );
+                        maxReduceSelectNT.reset();
+                    } else if ((reduce == maxReduceNT.reduce)
+                        && maxReduceSelectNT.isSelected()) {
+                        maxReduceNT = ConflictReduce( reduce, v, c );
+                    }
+                } else {
+                    if (reduce > maxReduceT.reduce) {
+                        maxReduceT = ConflictReduce( reduce, v, c );
+                        maxReduceSelectT.reset();
+                    } else if ((reduce == maxReduceT.reduce)
+                        && maxReduceSelectT.isSelected()) {
+                        maxReduceT = ConflictReduce( reduce, v, c );
+                    }
+                }
+            }
+        }
+
+        // check if there is an uncolored vertex reduction
+        ConflictReduce maxReduce =
+            ((((uncoloredVertices.size() - maxReduceT.reduce) < minUncoloredNum)
+            && (maxReduceNT.reduce < maxReduceT.reduce)) ? maxReduceT : maxReduceNT);
+
+        if (maxReduce.reduce != -gc->MAX_CONFLICT) {    // there is valid move
+            // uncolor the neighbors in the destination class and forbid them to return
+            int tabuTenure = iterCount + uncoloredVertices.size() + gc->TABU_TENURE_BASE + tabuTenurePerturb();
+            const AdjVertex &av = gc->adjVertexList[maxReduce.vertex];
+            for (AdjVertex::const_iterator iter = av.begin(); iter != av.end(); iter++) {
+                if (vertexColor[*iter] == maxReduce.desColor) {
+                    applyMove( *iter, uncolored() );
+                    uncoloredVertices.insert( *iter );
+                    tabu[rowOf( *iter ) + maxReduce.desColor] = tabuTenure;
+                }
+            }
+            applyMove( maxReduce.vertex, maxReduce.desColor );
+            uncoloredVertices.eraseElement( maxReduce.vertex );
+
+            // update local optima
+            if (minUncoloredNum > uncoloredVertices.size()) {
+                minUncoloredNum = uncoloredVertices.size();
+                localOptima = *this;
+            }
+        }
+    }
+
+    // replace the current solution with the local optima and complete it
+    *this = localOptima;
+    colorUncoloredVertices();
+
+    return iterCount;
+}
+
+void GraphColoring::Solution::uncolorConflictVertices( BidirectionIndex &uncoloredVertices )
+{
+    // the conflict of a vertex never increases by uncoloring others,
+    // so the coloring is legal after a single pass
+    for (int vertex = 0; vertex < gc->vertexNum; vertex++) {
+        if (adjColorTab[rowOf( vertex ) + vertexColor[vertex]] > 0) {
+            applyMove( vertex, uncolored() );
+            uncoloredVertices.insert( vertex );
+        }
+    }
+}
+
+void GraphColoring::Solution::colorUncoloredVertices()
+{
+    for (int vertex = 0; vertex < gc->vertexNum; vertex++) {
+        if (vertexColor[vertex] == uncolored()) {
+            RandSelect minConflictSelect;
+            const int *ac = &adjColorTab[rowOf( vertex )];
+            Color desColor = 0;
+            for (int c = 1; c < gc->colorNum; c++) {
+                if (ac[c] < ac[desColor]) {
+                    desColor = c;
+                    minConflictSelect.reset();
+                } else if ((ac[c] == ac[desColor]) && minConflictSelect.isSelected()) {
+                    desColor = c;
+                }
+            }
+            applyMove( vertex, desColor );
+        }
+    }
+}
+
+void GraphColoring::Solution::perturb( PerturbType type, int strength )
+{
+    switch (type) {
+        case CLASS_RECOLOR:
+            if (strength <= 0) {
+                RangeRand rrClassNum( 1, max( 1, gc->colorNum / 2 ) );
+                strength = rrClassNum();
+            }
+            recolorRandomClass( strength );
+            break;
+        case KEMPE_CHAIN_SWAP:
+            if (strength <= 0) {
+                RangeRand rrChainNum( 1, gc->colorNum );
+                strength = rrChainNum();
+            }
+            swapRandomKempeChain( strength );
+            break;
+        default:
+            if (strength <= 0) {
+                RangeRand rrVertexNum( 1, gc->vertexNum );
+                strength = rrVertexNum();
+            }
+            recolorRandomVertex( strength );
+            break;
+    }
+}
+
+void GraphColoring::Solution::recolorRandomVertex( int vertexNum )
 {
     RangeRand rrColor( 0, gc->colorNum - 1 );
     RangeRand rrVertex( 0, gc->vertexNum - 1 );
-    RangeRand rrVertexNum( 1, gc->vertexNum );
-    int perturbVertexNum = rrVertexNum();
 
-    for (; perturbVertexNum > 0; perturbVertexNum--) {
-        vertexColor[rrVertex()] = rrColor();
+    for (; vertexNum > 0; vertexNum--) {
+        int vertex = rrVertex();
+        Color color = rrColor();
+        if (color != vertexColor[vertex]) {
+            applyMove( vertex, color );
+        }
     }
+}
 
-    initDataStructure();
+void GraphColoring::Solution::recolorRandomClass( int classNum )
+{
+    if (gc->colorNum < 2) {
+        return;
+    }
+
+    RangeRand rrColor( 0, gc->colorNum - 1 );
+    RangeRand rrOtherColor( 0, gc->colorNum - 2 );
+    vector<bool> isChosen( gc->colorNum, false );
+    for (; classNum > 0; classNum--) {
+        isChosen[rrColor()] = true;
+    }
+
+    // collect the vertices of all chosen classes in one pass before moving any of them
+    vector<int> members;
+    for (int vertex = 0; vertex < gc->vertexNum; vertex++) {
+        if (isChosen[vertexColor[vertex]]) {
+            members.push_back( vertex );
+        }
+    }
+
+    for (size_t i = 0; i < members.size(); i++) {
+        Color color = vertexColor[members[i]];
+        Color desColor = rrOtherColor();    // skip the original color
+        applyMove( members[i], ((desColor < color) ? desColor : (desColor + 1)) );
+    }
+}
+
+void GraphColoring::Solution::swapRandomKempeChain( int chainNum )
+{
+    if (gc->colorNum < 2) {
+        return;
+    }
+
+    RangeRand rrVertex( 0, gc->vertexNum - 1 );
+    RangeRand rrOtherColor( 0, gc->colorNum - 2 );
+    vector<bool> isVisited( gc->vertexNum );
+    vector<int> chain;
+    for (; chainNum > 0; chainNum--) {
+        int start = rrVertex();
+        Color color1 = vertexColor[start];
+        Color color2 = rrOtherColor();
+        if (color2 >= color1) {
+            color2++;
+        }
+
+        // collect the connected component in the subgraph of the two colors
+        chain.clear();
+        chain.push_back( start );
+        isVisited[start] = true;
+        for (size_t i = 0; i < chain.size(); i++) {
+            const AdjVertex &av = gc->adjVertexList[chain[i]];
+            for (AdjVertex::const_iterator iter = av.begin(); iter != av.end(); iter++) {
+                if (!isVisited[*iter]
+                    && ((vertexColor[*iter] == color1) || (vertexColor[*iter] == color2))) {
+                    isVisited[*iter] = true;
+                    chain.push_back( *iter );
+                }
+            }
+        }
+
+        // swap the two colors on the chain (and clear the marks for the next chain)
+        for (size_t i = 0; i < chain.size(); i++) {
+            applyMove( chain[i], ((vertexColor[chain[i]] == color1) ? color2 : color1) );
+            isVisited[chain[i]] = false;
+        }
+    }
+}
+
+int GraphColoring::Solution::distance( const Solution &s ) const
+{
+    int colorNum = gc->colorNum;
+
+    // count vertices in each pair of color classes
+    vector<int> &overlap( gc->matchingBuffer.overlap );
+    overlap.assign( colorNum * colorNum, 0 );
+    for (int i = 0; i < gc->vertexNum; i++) {
+        overlap[vertexColor[i] * colorNum + s.vertexColor[i]]++;
+    }
+
+    // vertices out of the matched classes need to be recolored
+    return (gc->vertexNum - maxWeightMatching( overlap, colorNum, gc->matchingBuffer ));
+}
+
+unsigned GraphColoring::Solution::vertexColorHash( int vertex, Color color )
+{
+    // integer hash by Thomas Wang on the combination of vertex and color
+    unsigned key = (static_cast<unsigned>(vertex) << 16) ^ static_cast<unsigned>(color);
+    key = (key ^ 61) ^ (key >> 16);
+    key += (key << 3);
+    key ^= (key >> 4);
+    key *= 0x27d4eb2d;
+    key ^= (key >> 15);
+    return key;
+}
+
+int GraphColoring::Solution::maxWeightMatching( const vector<int> &weight, int n, MatchingBuffer &buffer )
+{
+    // Hungarian algorithm minimizing the negative weight (1-based indices)
+    vector<int> &u( buffer.rowPotential );
+    vector<int> &v( buffer.colPotential );
+    vector<int> &match( buffer.match );
+    vector<int> &way( buffer.way );
+    vector<int> &minSlack( buffer.minSlack );
+    vector<bool> &used( buffer.used );
+    u.assign( n + 1, 0 );
+    v.assign( n + 1, 0 );
+    match.assign( n + 1, 0 );
+    way.assign( n + 1, 0 );
+
+    for (int row = 1; row <= n; row++) {
+        match[0] = row;
+        int col0 = 0;
+        minSlack.assign( n + 1, INT_MAX );
+        used.assign( n + 1, false );
+        do {
+            used[col0] = true;
+            int row0 = match[col0];
+            int delta = INT_MAX;
+            int col1 = 0;
+            for (int col = 1; col <= n; col++) {
+                if (!used[col]) {
+                    int slack = -weight[(row0 - 1) * n + (col - 1)] - u[row0] - v[col];
+                    if (slack < minSlack[col]) {
+                        minSlack[col] = slack;
+                        way[col] = col0;
+                    }
+                    if (minSlack[col] < delta) {
+                        delta = minSlack[col];
+                        col1 = col;
+                    }
+                }
+            }
+            for (int col = 0; col <= n; col++) {
+                if (used[col]) {
+                    u[match[col]] += delta;
+                    v[col] -= delta;
+                } else {
+                    minSlack[col] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (match[col0] != 0);
+        do {
+            int col1 = way[col0];
+            match[col0] = match[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    int totalWeight = 0;
+    for (int col = 1; col <= n; col++) {
+        totalWeight += weight[(match[col] - 1) * n + (col - 1)];
+    }
+    return totalWeight;
+}
+
+void GraphColoring::Solution::insertEdge( int v1, int v2 )
+{
+    int c1 = vertexColor[v1];
+    int c2 = vertexColor[v2];
+    adjColorTab[rowOf( v1 ) + c2]++;
+    adjColorTab[rowOf( v2 ) + c1]++;
+    if (c1 == c2) {
+        conflictEdgeNum++;
+        if (adjColorTab[rowOf( v1 ) + c1] == 1) {
+            conflictVertices.insert( v1 );
+        }
+        if (adjColorTab[rowOf( v2 ) + c2] == 1) {
+            conflictVertices.insert( v2 );
+        }
+    }
+}
+
+void GraphColoring::Solution::removeEdge( int v1, int v2 )
+{
+    int c1 = vertexColor[v1];
+    int c2 = vertexColor[v2];
+    adjColorTab[rowOf( v1 ) + c2]--;
+    adjColorTab[rowOf( v2 ) + c1]--;
+    if (c1 == c2) {
+        conflictEdgeNum--;
+        if (adjColorTab[rowOf( v1 ) + c1] <= 0) {
+            conflictVertices.eraseElement( v1 );
+        }
+        if (adjColorTab[rowOf( v2 ) + c2] <= 0) {
+            conflictVertices.eraseElement( v2 );
+        }
+    }
 }
 
 GraphColoring::Solution::operator GraphColoring::ColorVertex() const
@@ -502,24 +1324,45 @@ void GraphColoring::initResultSheet( std::ofstream &csvFile )
 void GraphColoring::appendResultToSheet(
     const std::string &instanceFileName, std::ofstream &csvFile ) const
 {
+    csvFile << getResultRowPrefix( instanceFileName );
+
+    csvFile << '(' << colorNum << ')';
+    for (VertexColor::const_iterator iter = optima.vertexColor.begin();
+        iter != optima.vertexColor.end(); iter++) {
+        csvFile << *iter << ' ';
+    }
+
+    csvFile << std::endl;
+}
+
+void GraphColoring::initResultSheet( ResultSink &sink )
+{
+    sink.appendLine( "Date, Instance, Algorithm, RandSeed, Duration, IterCount, GenerationCount, Optima, Solution" );
+}
+
+void GraphColoring::appendResultToSheet(
+    const std::string &instanceFileName, ResultSink &sink ) const
+{
+    ostringstream row;
+    row << getResultRowPrefix( instanceFileName ) << '(' << colorNum << ')';
+    sink.appendRow( row.str(), optima.vertexColor, colorNum );
+}
+
+std::string GraphColoring::getResultRowPrefix( const std::string &instanceFileName ) const
+{
+    ostringstream row;
     if (check() != optima.conflictEdgeNum) {
-        csvFile << "[LogicError] ";
+        row << "[LogicError] ";
     }
 
-    csvFile << Timer::getLocalTime() << ", "
+    row << Timer::getLocalTime() << ", "
         << instanceFileName << ", "
         << SOLVING_ALGORITHM << ", "
-        << Random::getSeed() << ", "
+        << randSeed << ", "
         << timer.getTotalDuration() << ", "
         << iterCount << ", "
         << generationCount << ", "
         << optima.conflictEdgeNum << ", ";
 
-    csvFile << '(' << colorNum << ')';
-    for (VertexColor::const_iterator iter = optima.vertexColor.begin();
-        iter != optima.vertexColor.end(); iter++) {
-        csvFile << *iter << ' ';
-    }
-
-    csvFile << std::endl;
+    return row.str();
 }
@@ -1,28 +1,54 @@
 /**
 *   usage : 1. construct the GraphColoring object
+*           2. [optional] call loadSolution() to use a previous coloring as the first individual
 *           2. call init() to set argument of the program and generate initial solutions
 *           2. call solve() to find solution
 *           3. call print() or appendResultToSheet() to record solution
+*               (append to a ResultSink to keep file I/O out of the solving thread)
+*           4. [optional] call setLowerBound() with computeLowerBound() before init(),
+*               then init() and solve() return at once if colorNum is less than it.
+*           4. [optional] call setCancelFlag(), setTimeLimit() or setProgressCallback() before init()
+*               to control the search from other threads.
+*           4. [optional] call setRandSeed() before init() in the thread which runs init() and solve()
+*               if it is not the thread which constructs the object (the seed may be per thread).
+*           5. [optional] call insertEdge() or removeEdge() to modify the graph, then call solve() again.
+*               (only the best individual is repaired by local search before the evolution,
+*               and the population is filled up to POPULATION_SIZE (at least 2) with new individuals,
+*               loop to 2 instead to restart with a new population)
+*           6. [optional] call reset() to solve another graph with the same object, then loop to 2.
+*               (it saves the construction cost when solving many small graphs)
 *
 *   algorithm:
 *           1. generate POPULATION_SIZE individuals for initial population.
-*           2. do tabu search on each individual.
+*           2. do steepest descent and then local search (TabuCol or PartialCol) on each individual.
 *           3. if there is an individual without conflict, [END].
 *               else :
 *               4. select one individual randomly as first parent.
 *               5. select one of the best individuals as second parent.
 *               6. combine two parents to generate the offspring.
-*               7. do local search on offspring.
+*               7. do steepest descent and then local search on offspring.
 *               8. if the offspring gets no conflict, [END].
 *                   else :
-*                   9. select the worst individual in the population.
-*                   10. if it is worse than the offspring, replace it with offspring.
-*                       else if the population size is smaller than (2 * POPULATION_SIZE), just add the offspring to population.
-*                       else shrink the population size to POPULATION_SIZE.
-*                   11. loop to 4.
+*                   9. if the offspring duplicates an individual (same hash or zero partition distance), drop it.
+*                   10. add the offspring to the population and select the individual with the worst
+*                       goodness score (a weighted sum of conflict and distance to the rest of the population).
+*                   11. if the worst is not the offspring, remove it from the population.
+*                       else if the population size is not larger than (2 * POPULATION_SIZE), just keep the offspring.
+*                       else drop the offspring and shrink the population size to POPULATION_SIZE by goodness score.
+*                   12. loop to 4.
 *
 *   note :  1. MAX_CONFLICT = vertexNum * vertexNum which may overflow if there are too many vertices.
 *           2. set generationCount to 0 to test tabu search.
+*           3. if TABU_TENURE_ADAPT_PERIOD is positive, the tabu tenure amplitude is enlarged by a quarter
+*               for one period each time the local optima is not improved for that many iterations,
+*               and it is restored to TABU_TENURE_AMP on improvement or after the enlarged period.
+*           4. the partition distance is the minimal number of vertices to be recolored to turn a solution
+*               into the other under the best matching of color classes (Hungarian algorithm on class overlap).
+*           5. TabuCol moves conflict vertices to minimize conflict edges in a complete coloring.
+*               PartialCol moves uncolored vertices into color classes (uncoloring the neighbors in it)
+*               to minimize uncolored vertices in a legal partial coloring, then colors the rest greedily.
+*               both of them use the same adjColorTab and applyMove(), where the uncolored vertices
+*               are in the extra color class colorNum. the tabu tenure amplitude of PartialCol is fixed.
 */
 
 #ifndef GRAPH_COLORING_H
@@ -30,11 +56,18 @@
 
 #include <vector>
 #include <set>
+#include <deque>
+#include <unordered_set>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
 
 #include "../CPPutilibs/Timer.h"
 #include "../CPPutilibs/Random.h"
@@ -42,6 +75,9 @@
 #include "../CPPutilibs/RandSelect.h"
 #include "../CPPutilibs/BidirectionIndex.h"
 
+#include "ResultSink.h"
+#include "MaxClique.h"
+
 
 class GraphColoring
 {
@@ -66,9 +102,42 @@ public:     // public types and constant
     // adjacent color for all vertices
     typedef std::vector<AdjColor> AdjColorTable;
 
-    const int MAX_CONFLICT; // calculated by vertex number
-    const int vertexNum;    // total vertex number
-    const int colorNum;     // total color number
+    // partition distance between each pair of individuals in population
+    typedef std::vector< std::vector<int> > DistanceTable;
+
+    // perturbation operators used in mutateIndividuals()
+    enum PerturbType
+    {
+        RANDOM_RECOLOR,     // recolor random vertices
+        CLASS_RECOLOR,      // recolor all vertices in random color classes
+        KEMPE_CHAIN_SWAP    // swap two colors in random Kempe chains
+    };
+
+    // local search engines after the steepest descent on each individual
+    enum LocalSearchType
+    {
+        TABU_COL,       // tabu search on complete colorings
+        PARTIAL_COL     // tabu search on legal partial colorings
+    };
+
+    static const int STOP_CHECK_INTERVAL_MASK = 0xFF;   // check stop condition every 256 iterations
+
+    struct Progress
+    {
+    public:
+        Progress( int g, int i, int c, double d )
+            : generationCount( g ), iterCount( i ), conflictEdgeNum( c ), duration( d )
+        {
+        }
+
+        int generationCount;
+        int iterCount;
+        int conflictEdgeNum;    // conflict of the optima
+        double duration;        // in seconds since init()
+    };
+
+    // called by solve() on each generation
+    typedef std::function<void( const Progress &progress )> ProgressCallback;
 
     struct Output
     {
@@ -83,6 +152,19 @@ public:     // public types and constant
     };
 
 private:    // private types
+    // buffers for the partition distance (reused by each call in the solving thread)
+    struct MatchingBuffer
+    {
+    public:
+        std::vector<int> overlap;   // vertices in each pair of color classes
+        std::vector<int> rowPotential;
+        std::vector<int> colPotential;
+        std::vector<int> match;     // row matched with each column
+        std::vector<int> way;
+        std::vector<int> minSlack;
+        std::vector<bool> used;
+    };
+
     class Solution
     {
     public:
@@ -105,19 +187,47 @@ private:    // private types
         Solution( const Solution &s );
         // copy solution and reset the tabu table
         Solution& operator=(const Solution &s);
+        // replace the coloring and reset the tabu table in the allocated buffers
+        void assign( const VertexColor &vc );
 
-        // search until local optima is found, then return iteration count
+        // steepest descent on conflict vertices until local optima is found, then return iteration count
         // (the object will be the optima in the search path after this is called)
         int localSearch();
+        // search by the engine selected in init(), then return iteration count
+        // (the object will be the optima in the search path after this is called,
+        // localOptima is only the buffer to record it during the search)
+        int search( Solution &localOptima );
         // search until maxIterCount is meet, then return iteration count
         // (the object will be the optima in the search path after this is called)
-        int tabuSearch();
+        int tabuSearch( Solution &localOptima );
+        // search on legal partial colorings until maxIterCount is meet or all vertices are colored,
+        // then color the rest vertices greedily and return iteration count
+        // (the object will be the optima in the search path after this is called)
+        int partialColSearch( Solution &localOptima );
 
-        // reset random colors for randomly selected vertices
-        void perturb();
+        // apply the operator strength times by incremental moves
+        // (non-positive strength means a random number in [1, vertexNum] for RANDOM_RECOLOR,
+        // [1, colorNum / 2] for CLASS_RECOLOR and [1, colorNum] for KEMPE_CHAIN_SWAP)
+        void perturb( PerturbType type, int strength );
 
         // return color conflictEdgeNum
         int evaluate() const { return conflictEdgeNum; }
+        // recolor the vertex and update adjColorTab, conflictVertices, conflictEdgeNum and hash
+        void applyMove( int vertex, Color desColor );
+
+        // return the hash of vertexColor which is updated along with each move
+        unsigned hash() const { return colorHash; }
+        // return true if the color of every vertex is the same
+        bool isSameAssign( const Solution &s ) const
+        {
+            return ((colorHash == s.colorHash) && (vertexColor == s.vertexColor));
+        }
+        // return the minimal number of vertices to recolor to turn this into s
+        int distance( const Solution &s ) const;
+
+        // update adjColorTab, conflictVertices and conflictEdgeNum for the edge
+        void insertEdge( int v1, int v2 );
+        void removeEdge( int v1, int v2 );
         // compare the conflictEdgeNum (the less is the better)
         friend bool operator<(const Solution &l, const Solution &r)
         {
@@ -137,27 +247,106 @@ private:    // private types
         // generate adjColorTable and evaluate conflictEdgeNum
         void initDataStructure();   // call it if vertexColor is changed
 
+        // the extra color class of the uncolored vertices in PartialCol
+        Color uncolored() const { return gc->colorNum; }
+        // index of the first entry for the vertex in the flattened tables
+        int rowOf( int vertex ) const { return vertex * (gc->colorNum + 1); }
+        int tableSize() const { return gc->vertexNum * (gc->colorNum + 1); }
+
+        // uncolor conflict vertices until the coloring is legal
+        void uncolorConflictVertices( BidirectionIndex &uncoloredVertices );
+        // move each uncolored vertex to the color with the least conflict
+        void colorUncoloredVertices();
+
+        void recolorRandomVertex( int vertexNum );
+        void recolorRandomClass( int classNum );
+        void swapRandomKempeChain( int chainNum );
+
+        // hash value for a vertex with certain color (XOR them for the hash of a solution)
+        static unsigned vertexColorHash( int vertex, Color color );
+        // return the maximal total weight of the perfect matching on a square matrix
+        static int maxWeightMatching( const std::vector<int> &weight, int n, MatchingBuffer &buffer );
+
     private:
         const GraphColoring *gc;  // avoid deep copy
 
         BidirectionIndex conflictVertices;
         int conflictEdgeNum;
         VertexColor vertexColor;
+        unsigned colorHash;
 
-        AdjColorTable adjColorTab;  // conflicts for each vertex with each color
-        AdjColorTable tabu;   // tabu a vertex changes to a color
+        // the tables are flattened into vertexNum rows of (colorNum + 1) entries
+        // (including the uncolored class), so that copying a solution reuses a single buffer
+        std::vector<int> adjColorTab;   // conflicts for each vertex with each color
+        std::vector<int> tabu;  // tabu a vertex changes to a color
     };
 
 public:     // solving procedure
     GraphColoring( const AdjVertexList &adjVertexList, int colorNum );
 
+    // switch to another graph and clear all solutions, keep the allocated buffers (solutions included),
+    // the random seed and the controls (cancel flag, time limit, callback and perturbation)
+    // (call init() and solve() after it as with a new object)
+    void reset( const AdjVertexList &adjVertexList, int colorNum );
+
     // set arguments of the algorithm and generate the initial population
+    // (the previous population is discarded but the optima is kept)
     void init( int tabuTenureBase = 0, int tabuTenureAmp = 9,
         int maxGenerationCount = 1000, int maxIterCount = 10000,
-        int populationSize = 1, int mutateIndividualNum = 0 );
+        int populationSize = 1, int mutateIndividualNum = 0,
+        double poolQualityWeight = 0.6, int tabuTenureAdaptPeriod = 0,
+        LocalSearchType localSearchType = TABU_COL );
     // find the optima and record it to attribute "optima".
     void solve();
 
+    // the search stops as soon as the flag is set (it must outlive the search)
+    void setCancelFlag( const std::atomic<bool> *cancel ) { cancelFlag = cancel; }
+    // the search stops after the time limit (in seconds) since init() (non-positive for no limit)
+    void setTimeLimit( double seconds ) { timeLimit = seconds; }
+    void setProgressCallback( const ProgressCallback &callback ) { progressCallback = callback; }
+    // seed the random number generator of the calling thread, the seed is logged with the result
+    void setRandSeed( int seed );
+    int getRandSeed() const { return randSeed; }
+    // set the operator to increase the diversification of the population after culling
+    // (non-positive strength means a random one, see Solution::perturb())
+    void setPerturbation( PerturbType type, int strength )
+    {
+        PERTURB_TYPE = type;
+        PERTURB_STRENGTH = strength;
+    }
+
+    // return the size of a clique found by greedy search and then exact search within the time limit
+    // (set exactTimeLimit to 0 to skip the exact search)
+    static int computeLowerBound( const AdjVertexList &adjVertexList, double exactTimeLimit = 0 );
+    // reset maxClique to the graph and reuse its buffers (such as one for each thread solving many graphs)
+    static int computeLowerBound( MaxClique &maxClique, const AdjVertexList &adjVertexList, double exactTimeLimit = 0 );
+    void setLowerBound( int lb ) { lowerBound = lb; }
+    int getLowerBound() const { return lowerBound; }
+    // return true if colorNum is less than the lower bound
+    bool isInfeasible() const { return (colorNum < lowerBound); }
+    // return true if the optima is legal and uses as many colors as the lower bound
+    bool isOptimal() const;
+    // return the number of colors used by the optima
+    int getUsedColorNum() const;
+
+    // add the coloring to the population like an offspring, return true if there is no conflict
+    // (call it between generations, such as in the progress callback)
+    bool immigrate( const VertexColor &vertexColor );
+
+    // use the coloring as the first individual in init() (invalid colors will be reassigned)
+    void loadSolution( const Output &sln );
+    // modify the graph and update all solutions incrementally
+    // (return false if any vertex is out of range, the edge is a self-loop,
+    // or it already exists / does not exist)
+    bool insertEdge( int v1, int v2 );
+    bool removeEdge( int v1, int v2 );
+
+    const Output& getOptima() const { return optima; }
+    int getIterCount() const { return iterCount; }
+    int getVertexNum() const { return vertexNum; }
+    int getColorNum() const { return colorNum; }
+    double getDuration() const { return timer.getTotalDuration(); }
+
     // return color conflictEdgeNum number
     int check() const;     // check optima
     // return color conflictEdgeNum number
@@ -168,36 +357,102 @@ public:     // solving procedure
     static void initResultSheet( std::ofstream &csvFile );
     void appendResultToSheet( const std::string &instanceFileName,
         std::ofstream &csvFile ) const;  // contain check()
+    // queue the result to the sink (the solution is stored in its solution file)
+    static void initResultSheet( ResultSink &sink );
+    void appendResultToSheet( const std::string &instanceFileName,
+        ResultSink &sink ) const;   // contain check()
 
 private:    // functional procedure
     void genInitPopulation( int size ); // contain optima recording
+    void repairPopulation();    // search on the best individual after the graph is modified
+    // the columns before the solution in a row of the result sheet (contain check())
+    std::string getResultRowPrefix( const std::string &instanceFileName ) const;
+    bool isStopped() const;     // return true if it is cancelled or out of time
+    bool isValidVertex( int v ) const { return ((v >= 0) && (v < vertexNum)); }
+    double getElapsedTime() const;
     SolutionIndexSet selectParents();
-    Solution combineParents( const SolutionIndexSet &parents );
+    Solution* combineParents( const SolutionIndexSet &parents );
     bool updateOptima( const Solution &sln );   // return true if there is no conflict
-    bool updatePopulation( const Solution &offspring ); // return true if the population is shrunk
+    // take the ownership of the offspring, return true if the population is shrunk
+    bool updatePopulation( Solution *offspring );
     void mutateIndividuals( int mutateIndividualNum );
 
+    // take a spare solution from solutionPool or allocate one if there is none
+    Solution* newSolution( const VertexColor &vc );
+    Solution* newSolution( const Solution &sln );
+    // give the solution back to solutionPool
+    void deleteSolution( Solution *sln ) { spareSolutions.push_back( sln ); }
+    // give all solutions back to solutionPool
+    void clearPopulation();
+    // call Solution::search() with the buffer kept for the local optima
+    int searchSolution( Solution &sln );
+
+    // keep populationDistance and populationHash consistent with population
+    // (the individual is owned by the population since it is added)
+    void addIndividual( Solution *sln );
+    // distance[i] is the distance from sln to population[i]
+    void addIndividual( Solution *sln, const std::vector<int> &distance );
+    void removeIndividual( int index );
+    // call it after the individual is modified with its hash before modification
+    void updateIndividual( int index, unsigned oldHash );
+    void updateIndividualDistance( int index );
+    // return true if sln is the same as an individual in population,
+    // otherwise set distance[i] to the distance from sln to population[i]
+    bool isDuplicate( const Solution &sln, std::vector<int> &distance ) const;
+    // return the index of the individual with the lowest goodness score
+    int selectWorstIndividual() const;
+
     static VertexColor genRandomColorAssign( int vertexNum, int colorNum );
+    // keep valid colors in vc and assign random color to the rest vertices
+    static VertexColor fixColorAssign( const VertexColor &vc, int vertexNum, int colorNum );
 
 private:    // attribute
+    // (only changed by reset())
+    int MAX_CONFLICT;   // calculated by vertex number
+    int vertexNum;      // total vertex number
+    int colorNum;       // total color number
+
     AdjVertexList adjVertexList;
 
     // solution and output
-    std::vector<Solution> population;
+    // (all solutions are kept in solutionPool which never shrinks, deque keeps their addresses)
+    std::deque<Solution> solutionPool;
+    std::vector<Solution*> spareSolutions;
+    std::vector<Solution*> population;
+    Solution *localOptimaBuffer;    // taken from solutionPool on the first search
+    DistanceTable populationDistance;
+    mutable MatchingBuffer matchingBuffer;  // for Solution::distance()
+    std::unordered_multiset<unsigned> populationHash;   // hash of each individual
     Output optima;
+    VertexColor initVertexColor;    // loaded by loadSolution()
+    bool isGraphModified;
+    int lowerBound;     // of the chromatic number (0 if it is unknown)
+
+    // control from outside
+    const std::atomic<bool> *cancelFlag;
+    double timeLimit;
+    std::chrono::steady_clock::time_point startTime;
+    ProgressCallback progressCallback;
 
     // information for log
     int iterCount;
     int generationCount;
     Timer timer;
+    int randSeed;
+    static std::mutex randSeedMutex;    // Random keeps the seed in a global
     // information about the algorithm (initialized in init())
     std::string SOLVING_ALGORITHM;
     int TABU_TENURE_BASE;
     int TABU_TENURE_AMP;
+    int TABU_TENURE_ADAPT_PERIOD;   // stagnation iterations before enlarging the amplitude (0 for fixed)
     int POPULATION_SIZE;
     int MAX_GENERATION_COUNT;
     int MAX_ITERATION_COUNT;
     int MUTATE_INDIVIDUAL_NUM;
+    double POOL_QUALITY_WEIGHT; // weight of conflict in goodness score, the rest is for distance
+    LocalSearchType LOCAL_SEARCH_TYPE;
+    PerturbType PERTURB_TYPE;   // set by setPerturbation()
+    int PERTURB_STRENGTH;
 };
 
 
@@ -0,0 +1,237 @@
+#include "GraphColoringAPI.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+
+using namespace std;
+
+
+SolveResult solveGraphColoring( const CsrGraph &graph, int colorNum,
+    const SolveOptions &options, const atomic<bool> *cancel,
+    const SolveProgressCallback &progressCallback )
+{
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    SolveResult result;
+    if (!graph.isValid() || (colorNum <= 0)) {
+        result.isInvalidInput = true;
+        return result;
+    }
+    if (graph.vertexNum() <= 0) {
+        return result;
+    }
+
+    GraphColoring::AdjVertexList adjVertexList( toAdjVertexList( graph ) );
+
+    result.lowerBound = GraphColoring::computeLowerBound( adjVertexList, options.cliqueTimeLimit );
+    if (colorNum < result.lowerBound) {
+        result.duration = chrono::duration<double>( chrono::steady_clock::now() - startTime ).count();
+        return result;
+    }
+
+    int threadNum = max( 1, options.threadNum );
+    int baseSeed = ((options.seed != 0) ? options.seed : static_cast<int>(time( 0 )));
+
+    // stop all searches if any of them succeeds or the caller cancels
+    atomic<bool> stop( false );
+    mutex resultMutex;
+    condition_variable finishCondition;
+    int finishedThreadNum = 0;
+    vector<GraphColoring::Output> outputs( threadNum, GraphColoring::Output( -1 ) );
+    vector<int> iterCounts( threadNum, 0 );
+
+    auto search = [&]( int t ) {
+        GraphColoring gc( adjVertexList, colorNum );
+        gc.setLowerBound( result.lowerBound );
+        gc.setRandSeed( baseSeed + t );
+
+        gc.setCancelFlag( ((threadNum == 1) && cancel) ? cancel : &stop );
+        gc.setTimeLimit( options.timeLimit );
+        if (progressCallback) {
+            gc.setProgressCallback( [&, t]( const GraphColoring::Progress &progress ) {
+                lock_guard<mutex> lock( resultMutex );
+                progressCallback( SolveProgress( t, progress ) );
+            } );
+        }
+
+        gc.init( options.tabuTenureBase, options.tabuTenureAmp,
+            options.maxGenerationCount, options.maxIterCount,
+            options.populationSize, options.mutateIndividualNum,
+            options.poolQualityWeight, options.tabuTenureAdaptPeriod,
+            options.localSearchType );
+        gc.solve();
+
+        if (gc.getOptima().conflictEdgeNum <= 0) {
+            stop = true;
+        }
+
+        lock_guard<mutex> lock( resultMutex );
+        outputs[t] = gc.getOptima();
+        iterCounts[t] = gc.getIterCount();
+        finishedThreadNum++;
+        finishCondition.notify_one();
+    };
+
+    if (threadNum == 1) {
+        search( 0 );
+    } else {
+        vector<thread> workers;
+        for (int t = 0; t < threadNum; t++) {
+            workers.push_back( thread( search, t ) );
+        }
+
+        // forward the cancel flag of the caller to all searches
+        {
+            unique_lock<mutex> lock( resultMutex );
+            while (finishedThreadNum < threadNum) {
+                finishCondition.wait_for( lock, chrono::milliseconds( 1 ) );
+                if (cancel && cancel->load( memory_order_relaxed )) {
+                    stop = true;
+                }
+            }
+        }
+
+        for (int t = 0; t < threadNum; t++) {
+            workers[t].join();
+        }
+    }
+
+    // pick the best coloring among all searches
+    for (int t = 0; t < threadNum; t++) {
+        result.iterCount += iterCounts[t];
+        if (outputs[t].vertexColor.empty()) {   // cancelled before any search
+            continue;
+        }
+        if ((result.conflictEdgeNum < 0)
+            || (outputs[t].conflictEdgeNum < result.conflictEdgeNum)) {
+            result.conflictEdgeNum = outputs[t].conflictEdgeNum;
+            result.vertexColor.swap( outputs[t].vertexColor );
+        }
+    }
+    result.duration = chrono::duration<double>( chrono::steady_clock::now() - startTime ).count();
+
+    return result;
+}
+
+BatchResult solveGraphColoringBatch( const vector<CsrGraph> &graphs,
+    const vector<int> &colorNums, const SolveOptions &options, const atomic<bool> *cancel )
+{
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    BatchResult batch;
+    int graphNum = static_cast<int>(min( graphs.size(), colorNums.size() ));
+    batch.results.resize( graphNum );
+
+    int threadNum = max( 1, min( options.threadNum, graphNum ) );
+    int baseSeed = ((options.seed != 0) ? options.seed : static_cast<int>(time( 0 )));
+    atomic<int> nextGraph( 0 );
+    atomic<int> solvedGraphNum( 0 );
+
+    auto work = [&]( int t ) {
+        // buffers reused by all graphs solved in this thread
+        GraphColoring::AdjVertexList adjVertexList;
+        GraphColoring gc( adjVertexList, 0 );
+        MaxClique maxClique;
+        gc.setRandSeed( baseSeed + t );
+        gc.setCancelFlag( cancel );
+        gc.setTimeLimit( options.timeLimit );
+
+        for (int i = nextGraph++; i < graphNum; i = nextGraph++) {
+            if (cancel && cancel->load( memory_order_relaxed )) {
+                break;
+            }
+
+            const CsrGraph &graph( graphs[i] );
+            SolveResult &result( batch.results[i] );
+            if (!graph.isValid() || (colorNums[i] <= 0)) {
+                result.isInvalidInput = true;
+                continue;
+            }
+            if (graph.vertexNum() <= 0) {
+                continue;
+            }
+
+            chrono::steady_clock::time_point graphStartTime = chrono::steady_clock::now();
+
+            toAdjVertexList( graph, adjVertexList );
+            gc.reset( adjVertexList, colorNums[i] );
+            result.lowerBound = GraphColoring::computeLowerBound( maxClique, adjVertexList, options.cliqueTimeLimit );
+            gc.setLowerBound( result.lowerBound );
+            if (!gc.isInfeasible()) {
+                gc.init( options.tabuTenureBase, options.tabuTenureAmp,
+                    options.maxGenerationCount, options.maxIterCount,
+                    options.populationSize, options.mutateIndividualNum,
+                    options.poolQualityWeight, options.tabuTenureAdaptPeriod,
+                    options.localSearchType );
+                gc.solve();
+
+                if (!gc.getOptima().vertexColor.empty()) {   // not cancelled before any search
+                    result.conflictEdgeNum = gc.getOptima().conflictEdgeNum;
+                    result.vertexColor = gc.getOptima().vertexColor;
+                }
+                result.iterCount = gc.getIterCount();
+            }
+            result.duration = chrono::duration<double>( chrono::steady_clock::now() - graphStartTime ).count();
+            solvedGraphNum++;
+        }
+    };
+
+    if (threadNum == 1) {
+        work( 0 );
+    } else {
+        vector<thread> workers;
+        for (int t = 0; t < threadNum; t++) {
+            workers.push_back( thread( work, t ) );
+        }
+        for (int t = 0; t < threadNum; t++) {
+            workers[t].join();
+        }
+    }
+
+    batch.solvedGraphNum = solvedGraphNum;
+    batch.duration = chrono::duration<double>( chrono::steady_clock::now() - startTime ).count();
+
+    return batch;
+}
+
+bool CsrGraph::isValid() const
+{
+    if (offsets.empty() || (offsets[0] != 0)
+        || (offsets.back() != static_cast<int>(adjacency.size()))) {
+        return false;
+    }
+
+    int n = vertexNum();
+    for (int v = 0; v < n; v++) {
+        if (offsets[v] > offsets[v + 1]) {
+            return false;
+        }
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+            if ((adjacency[i] < 0) || (adjacency[i] >= n) || (adjacency[i] == v)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+GraphColoring::AdjVertexList toAdjVertexList( const CsrGraph &graph )
+{
+    GraphColoring::AdjVertexList adjVertexList;
+    toAdjVertexList( graph, adjVertexList );
+
+    return adjVertexList;
+}
+
+void toAdjVertexList( const CsrGraph &graph, GraphColoring::AdjVertexList &adjVertexList )
+{
+    int vertexNum = graph.vertexNum();
+    adjVertexList.resize( vertexNum );
+    for (int v = 0; v < vertexNum; v++) {
+        adjVertexList[v].assign( graph.adjacency.begin() + graph.offsets[v],
+            graph.adjacency.begin() + graph.offsets[v + 1] );
+    }
+}
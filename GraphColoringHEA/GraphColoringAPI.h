@@ -0,0 +1,141 @@
+/**
+*   usage : 1. fill a CsrGraph with the adjacency of every vertex (each edge in both directions)
+*           2. set SolveOptions and call solveGraphColoring()
+*           3. read the coloring from the returned SolveResult
+*
+*   note :  1. there is no file or console I/O, the caller owns all logging.
+*           2. with threadNum > 1, independent searches run in parallel and the first
+*               one without conflict stops the others.
+*           3. the cancel flag can be set from any thread, the search will return the best
+*               coloring found so far shortly after it.
+*           4. the progress callback is invoked from the solving threads, but never concurrently.
+*           5. thread t is seeded with (seed + t), where the seed is taken from the time if it is 0.
+*               runs with threadNum > 1 are not reproducible, since the first search without conflict
+*               stops the others and the random number generator may be shared by the threads.
+*           6. a clique is searched before solving, if colorNum is less than its size,
+*               no search will be done and SolveResult::lowerBound tells why.
+*           7. solveGraphColoringBatch() solves many (small) graphs, each one by a single
+*               search. each worker thread takes the next unsolved graph and reuses its own
+*               GraphColoring object, clique engine and adjacency buffers, so the seed is set once per thread.
+*               threadNum is the number of worker threads and timeLimit is for each graph.
+*           8. the graph is checked by CsrGraph::isValid() before solving, an invalid graph or a non-positive
+*               colorNum is not searched and SolveResult::isInvalidInput is set.
+*/
+
+#ifndef GRAPH_COLORING_API_H
+
+
+#include <vector>
+#include <atomic>
+#include <functional>
+
+#include "GraphColoring.h"
+
+
+// compressed sparse row adjacency
+struct CsrGraph
+{
+public:
+    int vertexNum() const { return static_cast<int>(offsets.size()) - 1; }
+    // return true if offsets start from 0 and never decrease, the last offset is the size of adjacency,
+    // and every neighbor is another vertex in [0, vertexNum)
+    bool isValid() const;
+
+    std::vector<int> offsets;   // adjacency of vertex v is in [offsets[v], offsets[v + 1])
+    std::vector<int> adjacency;
+};
+
+struct SolveOptions
+{
+public:
+    SolveOptions()
+        : timeLimit( 0 ), cliqueTimeLimit( 0 ), seed( 0 ), threadNum( 1 ),
+        tabuTenureBase( 0 ), tabuTenureAmp( 9 ), tabuTenureAdaptPeriod( 0 ),
+        maxGenerationCount( 1000 ), maxIterCount( 100000 ),
+        populationSize( 10 ), mutateIndividualNum( 2 ), poolQualityWeight( 0.6 ),
+        localSearchType( GraphColoring::TABU_COL )
+    {
+    }
+
+    double timeLimit;   // in seconds (non-positive for no limit)
+    double cliqueTimeLimit; // in seconds for exact max clique search (non-positive for greedy only)
+    int seed;           // random seed of the first thread (0 for seed by time), thread t uses seed + t
+    int threadNum;      // number of independent searches
+
+    // algorithm arguments (see GraphColoring::init())
+    int tabuTenureBase;
+    int tabuTenureAmp;
+    int tabuTenureAdaptPeriod;
+    int maxGenerationCount;
+    int maxIterCount;
+    int populationSize;
+    int mutateIndividualNum;
+    double poolQualityWeight;
+    GraphColoring::LocalSearchType localSearchType;
+};
+
+struct SolveProgress
+{
+public:
+    SolveProgress( int t, const GraphColoring::Progress &p )
+        : thread( t ), progress( p )
+    {
+    }
+
+    int thread;     // index of the search which reports the progress
+    GraphColoring::Progress progress;
+};
+
+typedef std::function<void( const SolveProgress &progress )> SolveProgressCallback;
+
+struct SolveResult
+{
+public:
+    SolveResult()
+        : conflictEdgeNum( -1 ), isInvalidInput( false ), lowerBound( 0 ), iterCount( 0 ), duration( 0 )
+    {
+    }
+
+    bool isLegal() const { return (conflictEdgeNum == 0); }
+
+    int conflictEdgeNum;    // negative if no search has been done
+    bool isInvalidInput;    // the graph is not valid (see CsrGraph::isValid()) or colorNum is not positive
+    GraphColoring::VertexColor vertexColor;
+    int lowerBound;         // size of the clique found
+    int iterCount;          // total iteration of all threads
+    double duration;        // in seconds
+};
+
+struct BatchResult
+{
+public:
+    BatchResult() : solvedGraphNum( 0 ), duration( 0 ) {}
+
+    // throughput of the whole batch
+    double graphsPerSecond() const { return ((duration > 0) ? (solvedGraphNum / duration) : 0); }
+
+    std::vector<SolveResult> results;   // in the same order as the graphs
+    int solvedGraphNum;     // graphs searched or proved infeasible before cancelled
+    double duration;        // in seconds
+};
+
+
+// find a coloring with colorNum colors for the graph
+SolveResult solveGraphColoring( const CsrGraph &graph, int colorNum,
+    const SolveOptions &options = SolveOptions(),
+    const std::atomic<bool> *cancel = 0,
+    const SolveProgressCallback &progressCallback = SolveProgressCallback() );
+
+// find a coloring with colorNums[i] colors for graphs[i]
+BatchResult solveGraphColoringBatch( const std::vector<CsrGraph> &graphs,
+    const std::vector<int> &colorNums,
+    const SolveOptions &options = SolveOptions(),
+    const std::atomic<bool> *cancel = 0 );
+
+GraphColoring::AdjVertexList toAdjVertexList( const CsrGraph &graph );
+// overwrite adjVertexList and keep the capacity of its rows
+void toAdjVertexList( const CsrGraph &graph, GraphColoring::AdjVertexList &adjVertexList );
+
+
+#define GRAPH_COLORING_API_H
+#endif
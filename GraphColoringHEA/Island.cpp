@@ -0,0 +1,576 @@
+#include "Island.h"
+
+#include <cstdlib>
+#include <climits>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+namespace
+{
+#ifdef _WIN32
+    typedef WSAPOLLFD PollFd;
+    int pollHandles( PollFd *fds, size_t num, int timeout ) { return WSAPoll( fds, static_cast<ULONG>(num), timeout ); }
+#else
+    typedef pollfd PollFd;
+    int pollHandles( PollFd *fds, size_t num, int timeout ) { return poll( fds, num, timeout ); }
+#endif
+
+    const size_t HEADER_SIZE = 16;
+    const string UNIX_PREFIX = "unix:";
+
+    void appendUint32( string &buf, unsigned n )
+    {
+        for (int b = 0; b < 32; b += 8) {
+            buf.push_back( static_cast<char>((n >> b) & 0xFF) );
+        }
+    }
+
+    unsigned readUint32( const char *data )
+    {
+        unsigned n = 0;
+        for (int i = 3; i >= 0; i--) {
+            n = (n << 8) | static_cast<unsigned char>(data[i]);
+        }
+        return n;
+    }
+
+    // split "<host>:<port>" and resolve it
+    bool resolve( const string &address, sockaddr_in &addr )
+    {
+        size_t colon = address.rfind( ':' );
+        if (colon == string::npos) {
+            return false;
+        }
+
+        addrinfo hints = addrinfo();
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *info = 0;
+        if (getaddrinfo( address.substr( 0, colon ).c_str(),
+            address.substr( colon + 1 ).c_str(), &hints, &info ) != 0) {
+            return false;
+        }
+        addr = *reinterpret_cast<sockaddr_in*>(info->ai_addr);
+        freeaddrinfo( info );
+        return true;
+    }
+}
+
+
+///=== [ IslandSocket ] ===============================
+
+const IslandSocket::Handle IslandSocket::INVALID_HANDLE = static_cast<IslandSocket::Handle>(-1);
+
+IslandSocket::Handle IslandSocket::listenOn( const string &address )
+{
+    if (!startup()) {
+        return INVALID_HANDLE;
+    }
+
+    Handle handle = INVALID_HANDLE;
+#ifndef _WIN32
+    if (address.compare( 0, UNIX_PREFIX.size(), UNIX_PREFIX ) == 0) {
+        sockaddr_un addr = sockaddr_un();
+        addr.sun_family = AF_UNIX;
+        string path( address.substr( UNIX_PREFIX.size() ) );
+        path.copy( addr.sun_path, sizeof( addr.sun_path ) - 1 );
+        unlink( addr.sun_path );
+
+        handle = socket( AF_UNIX, SOCK_STREAM, 0 );
+        if ((handle == INVALID_HANDLE)
+            || (bind( handle, reinterpret_cast<sockaddr*>(&addr), sizeof( addr ) ) != 0)
+            || (listen( handle, SOMAXCONN ) != 0)) {
+            close( handle );
+            return INVALID_HANDLE;
+        }
+        return handle;
+    }
+#endif
+
+    sockaddr_in addr;
+    if (!resolve( address, addr )) {
+        return INVALID_HANDLE;
+    }
+    handle = socket( AF_INET, SOCK_STREAM, 0 );
+    int reuse = 1;
+    if ((handle == INVALID_HANDLE)
+        || (setsockopt( handle, SOL_SOCKET, SO_REUSEADDR,
+        reinterpret_cast<const char*>(&reuse), sizeof( reuse ) ) != 0)
+        || (bind( handle, reinterpret_cast<sockaddr*>(&addr), sizeof( addr ) ) != 0)
+        || (listen( handle, SOMAXCONN ) != 0)) {
+        close( handle );
+        return INVALID_HANDLE;
+    }
+    return handle;
+}
+
+IslandSocket::Handle IslandSocket::connectTo( const string &address )
+{
+    if (!startup()) {
+        return INVALID_HANDLE;
+    }
+
+    Handle handle = INVALID_HANDLE;
+#ifndef _WIN32
+    if (address.compare( 0, UNIX_PREFIX.size(), UNIX_PREFIX ) == 0) {
+        sockaddr_un addr = sockaddr_un();
+        addr.sun_family = AF_UNIX;
+        address.substr( UNIX_PREFIX.size() ).copy( addr.sun_path, sizeof( addr.sun_path ) - 1 );
+
+        handle = socket( AF_UNIX, SOCK_STREAM, 0 );
+        if ((handle == INVALID_HANDLE)
+            || (connect( handle, reinterpret_cast<sockaddr*>(&addr), sizeof( addr ) ) != 0)) {
+            close( handle );
+            return INVALID_HANDLE;
+        }
+        return handle;
+    }
+#endif
+
+    sockaddr_in addr;
+    if (!resolve( address, addr )) {
+        return INVALID_HANDLE;
+    }
+    handle = socket( AF_INET, SOCK_STREAM, 0 );
+    if ((handle == INVALID_HANDLE)
+        || (connect( handle, reinterpret_cast<sockaddr*>(&addr), sizeof( addr ) ) != 0)) {
+        close( handle );
+        return INVALID_HANDLE;
+    }
+
+    // messages are small and should not wait for more data
+    int noDelay = 1;
+    setsockopt( handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof( noDelay ) );
+    return handle;
+}
+
+IslandSocket::Handle IslandSocket::acceptFrom( Handle listener )
+{
+    Handle handle = accept( listener, 0, 0 );
+    return ((handle == INVALID_HANDLE) ? INVALID_HANDLE : handle);
+}
+
+void IslandSocket::close( Handle handle )
+{
+    if (handle == INVALID_HANDLE) {
+        return;
+    }
+    // wake up the thread blocked on it
+#ifdef _WIN32
+    shutdown( handle, SD_BOTH );
+    closesocket( handle );
+#else
+    shutdown( handle, SHUT_RDWR );
+    ::close( handle );
+#endif
+}
+
+bool IslandSocket::send( Handle handle, const Message &msg )
+{
+    const GraphColoring::VertexColor &vertexColor( msg.output.vertexColor );
+
+    string buf;
+    appendUint32( buf, msg.type );
+    appendUint32( buf, msg.colorNum );
+    appendUint32( buf, msg.output.conflictEdgeNum );
+    appendUint32( buf, static_cast<unsigned>(vertexColor.size()) );
+    if (!vertexColor.empty()) {
+        packVertexColor( vertexColor, msg.colorNum, buf );
+    }
+
+    return sendAll( handle, buf.data(), buf.size() );
+}
+
+bool IslandSocket::receive( Handle handle, Message &msg )
+{
+    vector<char> data( HEADER_SIZE );
+    if (!receiveAll( handle, &data[0], HEADER_SIZE )) {
+        return false;
+    }
+
+    size_t size = messageSize( &data[0] );
+    if (size == 0) {
+        return false;
+    }
+    data.resize( size );
+    if ((size > HEADER_SIZE) && !receiveAll( handle, &data[HEADER_SIZE], size - HEADER_SIZE )) {
+        return false;
+    }
+
+    return decode( &data[0], msg );
+}
+
+bool IslandSocket::receiveAvailable( Handle handle, string &buf )
+{
+    char chunk[RECEIVE_CHUNK_SIZE];
+#ifdef _WIN32
+    int received = ::recv( handle, chunk, RECEIVE_CHUNK_SIZE, 0 );
+#else
+    ssize_t received = ::recv( handle, chunk, RECEIVE_CHUNK_SIZE, 0 );
+#endif
+    if (received <= 0) {
+        return false;
+    }
+    buf.append( chunk, received );
+    return true;
+}
+
+bool IslandSocket::extract( string &buf, Message &msg, bool &isComplete )
+{
+    isComplete = false;
+    if (buf.size() < HEADER_SIZE) {
+        return true;
+    }
+
+    size_t size = messageSize( buf.data() );
+    if (size == 0) {
+        return false;
+    }
+    if (buf.size() < size) {
+        return true;
+    }
+
+    isComplete = true;
+    bool isValid = decode( buf.data(), msg );
+    buf.erase( 0, size );
+    return isValid;
+}
+
+size_t IslandSocket::messageSize( const char *header )
+{
+    unsigned type = readUint32( header );
+    unsigned colorNum = readUint32( header + 4 );
+    unsigned conflictEdgeNum = readUint32( header + 8 );
+    unsigned vertexNum = readUint32( header + 12 );
+
+    // check the header before allocating anything by it
+    if (((type != ELITE) && (type != STOP))
+        || (colorNum > static_cast<unsigned>(MAX_COLOR_NUM))
+        || (vertexNum > static_cast<unsigned>(MAX_VERTEX_NUM))
+        || (conflictEdgeNum > static_cast<unsigned>(INT_MAX))
+        || ((vertexNum > 0) && (colorNum == 0))) {
+        return 0;
+    }
+
+    if (vertexNum == 0) {
+        return HEADER_SIZE;
+    }
+    return (HEADER_SIZE + (static_cast<size_t>(vertexNum) * bitWidth( static_cast<int>(colorNum) ) + 7) / 8);
+}
+
+bool IslandSocket::decode( const char *data, Message &msg )
+{
+    msg.type = static_cast<MessageType>(readUint32( data ));
+    msg.colorNum = static_cast<int>(readUint32( data + 4 ));
+    msg.output.conflictEdgeNum = static_cast<int>(readUint32( data + 8 ));
+    int vertexNum = static_cast<int>(readUint32( data + 12 ));
+
+    msg.output.vertexColor.clear();
+    if (vertexNum > 0) {
+        unpackVertexColor( data + HEADER_SIZE, vertexNum, msg.colorNum, msg.output.vertexColor );
+
+        // the packed width may hold values larger than any color
+        for (size_t i = 0; i < msg.output.vertexColor.size(); i++) {
+            if (msg.output.vertexColor[i] >= msg.colorNum) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool IslandSocket::sendAll( Handle handle, const char *data, size_t size )
+{
+    while (size > 0) {
+#ifdef _WIN32
+        int sent = ::send( handle, data, static_cast<int>(size), 0 );
+#else
+        ssize_t sent = ::send( handle, data, size, MSG_NOSIGNAL );
+#endif
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+bool IslandSocket::receiveAll( Handle handle, char *data, size_t size )
+{
+    while (size > 0) {
+#ifdef _WIN32
+        int received = ::recv( handle, data, static_cast<int>(size), 0 );
+#else
+        ssize_t received = ::recv( handle, data, size, 0 );
+#endif
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool IslandSocket::startup()
+{
+#ifdef _WIN32
+    static bool isStarted = false;
+    if (!isStarted) {
+        WSADATA wsaData;
+        isStarted = (WSAStartup( MAKEWORD( 2, 2 ), &wsaData ) == 0);
+    }
+    return isStarted;
+#else
+    return true;
+#endif
+}
+
+
+///=== [ IslandCoordinator ] ===============================
+
+IslandCoordinator::IslandCoordinator( const string &addr, int cn, int vn )
+    : address( addr ), colorNum( cn ), vertexNum( vn )
+{
+}
+
+GraphColoring::Output IslandCoordinator::run( int workerNum )
+{
+    IslandSocket::Handle listener = IslandSocket::listenOn( address );
+    if (listener == IslandSocket::INVALID_HANDLE) {
+        return GraphColoring::Output( -1 );
+    }
+
+    vector<PollFd> fds( 1 );
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+    // partial messages from each worker (buffers[i] is for fds[i], buffers[0] is not used)
+    vector<string> buffers( 1 );
+
+    int connectedNum = 0;
+    bool isSolved = false;
+    while (!isSolved && ((connectedNum < workerNum) || (fds.size() > 1))) {
+        if (pollHandles( &fds[0], fds.size(), -1 ) < 0) {
+            break;
+        }
+
+        // accept new workers, and stop the extra ones at once so that the listener is drained
+        if (fds[0].revents & POLLIN) {
+            IslandSocket::Handle worker = IslandSocket::acceptFrom( listener );
+            if ((worker != IslandSocket::INVALID_HANDLE) && (connectedNum >= workerNum)) {
+                IslandSocket::send( worker, IslandSocket::Message( IslandSocket::STOP ) );
+                IslandSocket::close( worker );
+            } else if (worker != IslandSocket::INVALID_HANDLE) {
+                PollFd fd;
+                fd.fd = worker;
+                fd.events = POLLIN;
+                fd.revents = 0;
+                fds.push_back( fd );
+                buffers.push_back( string() );
+                connectedNum++;
+            }
+        }
+
+        // exchange elites without waiting for the rest of a partial message
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            bool isAlive = ((fds[i].revents & POLLIN)
+                && IslandSocket::receiveAvailable( fds[i].fd, buffers[i] ));  // or the worker exits
+            while (isAlive && !isSolved) {
+                IslandSocket::Message msg;
+                bool isComplete;
+                isAlive = IslandSocket::extract( buffers[i], msg, isComplete );
+                if (!isAlive || !isComplete) {
+                    break;
+                }
+                if (msg.type != IslandSocket::ELITE) {
+                    continue;
+                }
+                if (!isCompatible( msg )) {
+                    isAlive = false;
+                    break;
+                }
+
+                int reply = addElite( msg.output );
+                if (msg.output.conflictEdgeNum <= 0) {
+                    isSolved = true;
+                } else if (reply >= 0) {
+                    IslandSocket::send( fds[i].fd, IslandSocket::Message(
+                        IslandSocket::ELITE, msg.colorNum, elitePool[reply] ) );
+                }
+            }
+
+            if (!isAlive) {
+                IslandSocket::close( fds[i].fd );
+                fds.erase( fds.begin() + i );
+                buffers.erase( buffers.begin() + i );
+                i--;
+            }
+        }
+    }
+
+    // broadcast stop to all workers
+    for (size_t i = 1; i < fds.size(); i++) {
+        IslandSocket::send( fds[i].fd, IslandSocket::Message( IslandSocket::STOP ) );
+        IslandSocket::close( fds[i].fd );
+    }
+    IslandSocket::close( listener );
+#ifndef _WIN32
+    if (address.compare( 0, UNIX_PREFIX.size(), UNIX_PREFIX ) == 0) {
+        unlink( address.substr( UNIX_PREFIX.size() ).c_str() );
+    }
+#endif
+
+    return (elitePool.empty() ? GraphColoring::Output( -1 ) : elitePool.front());
+}
+
+bool IslandCoordinator::isCompatible( const IslandSocket::Message &msg )
+{
+    int n = static_cast<int>(msg.output.vertexColor.size());
+    if (n <= 0) {
+        return false;
+    }
+    if (colorNum <= 0) {
+        colorNum = msg.colorNum;
+    }
+    if (vertexNum <= 0) {
+        vertexNum = n;
+    }
+
+    return ((msg.colorNum == colorNum) && (n == vertexNum));
+}
+
+int IslandCoordinator::addElite( const GraphColoring::Output &elite )
+{
+    bool isDuplicate = false;
+    for (size_t i = 0; i < elitePool.size(); i++) {
+        if (elitePool[i].vertexColor == elite.vertexColor) {
+            isDuplicate = true;
+            break;
+        }
+    }
+
+    // insert in order of conflict and drop the worst one if the pool is full
+    if (!isDuplicate) {
+        vector<GraphColoring::Output>::iterator iter = elitePool.begin();
+        while ((iter != elitePool.end()) && (iter->conflictEdgeNum <= elite.conflictEdgeNum)) {
+            iter++;
+        }
+        elitePool.insert( iter, elite );
+        if (static_cast<int>(elitePool.size()) > ELITE_POOL_SIZE) {
+            elitePool.pop_back();
+        }
+    }
+
+    // reply with a random elite which differs from the sender
+    if (elitePool.size() < 2) {
+        return -1;
+    }
+    RangeRand rr( 0, elitePool.size() - 1 );
+    int reply;
+    do {
+        reply = rr();
+    } while (elitePool[reply].vertexColor == elite.vertexColor);
+
+    return reply;
+}
+
+
+///=== [ IslandWorker ] ===============================
+
+IslandWorker::IslandWorker( const string &address )
+    : handle( IslandSocket::connectTo( address ) ), stop( false )
+{
+    if (isConnected()) {
+        receiver = thread( &IslandWorker::receiveLoop, this );
+    }
+}
+
+IslandWorker::~IslandWorker()
+{
+    IslandSocket::close( handle );
+    if (receiver.joinable()) {
+        receiver.join();
+    }
+}
+
+bool IslandWorker::run( GraphColoring &gc, int tabuTenureBase, int tabuTenureAmp,
+    int maxGenerationCount, int maxIterCount,
+    int populationSize, int mutateIndividualNum )
+{
+    gc.setCancelFlag( &stop );
+    gc.setProgressCallback( [&]( const GraphColoring::Progress &progress ) {
+        migrate( gc, progress );
+    } );
+
+    gc.init( tabuTenureBase, tabuTenureAmp, maxGenerationCount, maxIterCount,
+        populationSize, mutateIndividualNum );
+    gc.solve();
+
+    // report the final optima (the coordinator stops others if there is no conflict)
+    const GraphColoring::Output &optima( gc.getOptima() );
+    if (isConnected() && !optima.vertexColor.empty()) {
+        IslandSocket::send( handle, IslandSocket::Message( IslandSocket::ELITE, gc.getColorNum(), optima ) );
+    }
+
+    gc.setProgressCallback( GraphColoring::ProgressCallback() );
+    return (optima.conflictEdgeNum <= 0);
+}
+
+void IslandWorker::receiveLoop()
+{
+    IslandSocket::Message msg;
+    while (IslandSocket::receive( handle, msg )) {
+        if (msg.type == IslandSocket::STOP) {
+            break;
+        } else if (msg.type == IslandSocket::ELITE) {
+            lock_guard<mutex> lock( immigrantMutex );
+            immigrants.push_back( GraphColoring::VertexColor() );
+            immigrants.back().swap( msg.output.vertexColor );
+        }
+    }
+
+    // stop on STOP or when the coordinator is gone
+    stop = true;
+}
+
+void IslandWorker::migrate( GraphColoring &gc, const GraphColoring::Progress &progress )
+{
+    vector<GraphColoring::VertexColor> arrived;
+    {
+        lock_guard<mutex> lock( immigrantMutex );
+        arrived.swap( immigrants );
+    }
+    for (size_t i = 0; i < arrived.size(); i++) {
+        gc.immigrate( arrived[i] );
+    }
+
+    if ((progress.generationCount % MIGRATION_INTERVAL) == 0) {
+        const GraphColoring::Output &optima( gc.getOptima() );
+        if (!IslandSocket::send( handle, IslandSocket::Message( IslandSocket::ELITE, gc.getColorNum(), optima ) )) {
+            stop = true;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/**
+*   usage : 1. start one IslandCoordinator and call run() with the number of workers
+*           2. start IslandWorker in each worker process, attach the GraphColoring object
+*               after construction and call run() instead of init() and solve()
+*           3. the coordinator returns the best coloring when any worker finds no conflict
+*               or all workers exit
+*
+*   address : "unix:<path>" for Unix-domain socket (not on Windows),
+*             "<host>:<port>" for TCP socket (IPv4).
+*
+*   protocol : each message is [type][colorNum][conflictEdgeNum][vertexNum][packed colors],
+*              where the numbers are 32-bit little-endian and the colors are packed by
+*              packVertexColor() (a STOP message has no vertex).
+*           1. worker -> coordinator: ELITE with the optima of the worker every
+*               MIGRATION_INTERVAL generations and after solving.
+*           2. coordinator -> worker: ELITE from the shared elite pool in reply to each ELITE.
+*           3. coordinator -> all workers: STOP after any ELITE without conflict.
+*/
+
+#ifndef ISLAND_H
+
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "GraphColoring.h"
+
+
+class IslandSocket
+{
+public:
+#ifdef _WIN32
+    typedef uintptr_t Handle;
+#else
+    typedef int Handle;
+#endif
+    static const Handle INVALID_HANDLE;
+
+    // messages with larger numbers are rejected as corrupted
+    static const int MAX_VERTEX_NUM = (1 << 24);
+    static const int MAX_COLOR_NUM = (1 << 16);
+
+    enum MessageType { ELITE = 1, STOP = 2 };
+
+    struct Message
+    {
+    public:
+        Message( MessageType t = STOP, int c = 0, const GraphColoring::Output &o = GraphColoring::Output( 0 ) )
+            : type( t ), colorNum( c ), output( o )
+        {
+        }
+
+        MessageType type;
+        int colorNum;
+        GraphColoring::Output output;
+    };
+
+    // return INVALID_HANDLE on failure
+    static Handle listenOn( const std::string &address );
+    static Handle connectTo( const std::string &address );
+    static Handle acceptFrom( Handle listener );
+    static void close( Handle handle );
+
+    // return false if the connection is broken
+    static bool send( Handle handle, const Message &msg );
+    // block until a whole message arrives, return false if the connection is broken or the message is corrupted
+    static bool receive( Handle handle, Message &msg );
+    // append the data which has arrived to buf without waiting for more (call it when the handle is readable),
+    // return false if the connection is closed or broken
+    static bool receiveAvailable( Handle handle, std::string &buf );
+    // take the first message out of buf, return false if it is corrupted
+    // (isComplete is set to false and buf is kept if the message has not fully arrived)
+    static bool extract( std::string &buf, Message &msg, bool &isComplete );
+
+private:
+    static const int RECEIVE_CHUNK_SIZE = 4096;
+
+    // return the size of the whole message with the header, or 0 if the header is corrupted
+    static size_t messageSize( const char *header );
+    // decode a whole message checked by messageSize(), return false if any color is out of range
+    static bool decode( const char *data, Message &msg );
+
+    static bool sendAll( Handle handle, const char *data, size_t size );
+    static bool receiveAll( Handle handle, char *data, size_t size );
+    static bool startup();
+};
+
+
+class IslandCoordinator
+{
+public:
+    static const int ELITE_POOL_SIZE = 16;
+
+    // elites must have colorNum colors and vertexNum vertices (0 to lock them by the first elite)
+    IslandCoordinator( const std::string &address, int colorNum = 0, int vertexNum = 0 );
+
+    // serve workers until any of them finds no conflict or all of them exit,
+    // return the best coloring received
+    // (workers which send elites of another color number or vertex number are dropped,
+    // and the ones connecting after workerNum workers are told to stop at once)
+    GraphColoring::Output run( int workerNum );
+
+private:
+    // return true if the elite matches the first one received
+    bool isCompatible( const IslandSocket::Message &msg );
+    // add to the elite pool and return the index of an elite to send back
+    int addElite( const GraphColoring::Output &elite );
+
+    std::string address;
+    int colorNum;   // locked by the first elite if it is not given
+    int vertexNum;
+    std::vector<GraphColoring::Output> elitePool;   // sorted by conflict
+};
+
+
+class IslandWorker
+{
+public:
+    static const int MIGRATION_INTERVAL = 10;   // generations between sending elites
+
+    IslandWorker( const std::string &address );
+    ~IslandWorker();
+
+    bool isConnected() const { return (handle != IslandSocket::INVALID_HANDLE); }
+
+    // init() and solve() on gc with migration, return true if no conflict is found
+    bool run( GraphColoring &gc, int tabuTenureBase, int tabuTenureAmp,
+        int maxGenerationCount, int maxIterCount,
+        int populationSize, int mutateIndividualNum );
+
+private:
+    IslandWorker( const IslandWorker & );
+    IslandWorker& operator=(const IslandWorker &);
+
+    void receiveLoop();
+    void migrate( GraphColoring &gc, const GraphColoring::Progress &progress );
+
+    IslandSocket::Handle handle;
+    std::atomic<bool> stop;
+    std::mutex immigrantMutex;
+    std::vector<GraphColoring::VertexColor> immigrants;
+    std::thread receiver;
+};
+
+
+#define ISLAND_H
+#endif
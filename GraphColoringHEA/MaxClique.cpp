@@ -0,0 +1,255 @@
+#include "MaxClique.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+
+MaxClique::MaxClique( const AdjVertexList &adjVertexList )
+    : vertexNum( 0 ), wordNum( 0 ), isTimeOut( false ), branchCount( 0 )
+{
+    reset( adjVertexList );
+}
+
+void MaxClique::reset( const AdjVertexList &adjVertexList )
+{
+    vertexNum = adjVertexList.size();
+    wordNum = (vertexNum + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    clique.clear();
+    currentClique.clear();
+
+    // renumber vertices in non-increasing degree order
+    degreeOrder.resize( vertexNum );
+    for (int v = 0; v < vertexNum; v++) {
+        degreeOrder[v] = make_pair( -static_cast<int>(adjVertexList[v].size()), v );
+    }
+    sort( degreeOrder.begin(), degreeOrder.end() );
+
+    originIndex.resize( vertexNum );
+    newIndex.resize( vertexNum );
+    for (int i = 0; i < vertexNum; i++) {
+        originIndex[i] = degreeOrder[i].second;
+        newIndex[degreeOrder[i].second] = i;
+    }
+
+    // never shrink the rows so that their capacity is kept for larger graphs
+    if (static_cast<int>(adjacency.size()) < vertexNum) {
+        adjacency.resize( vertexNum );
+    }
+    for (int v = 0; v < vertexNum; v++) {
+        adjacency[v].assign( wordNum, 0 );
+    }
+    for (int v = 0; v < vertexNum; v++) {
+        const vector<int> &adjVertex( adjVertexList[v] );
+        for (size_t i = 0; i < adjVertex.size(); i++) {
+            set( adjacency[newIndex[v]], newIndex[adjVertex[i]] );
+        }
+    }
+
+    greedyCandidate.resize( wordNum );
+    greedyUnvisited.resize( wordNum );
+}
+
+int MaxClique::greedySearch()
+{
+    for (int v = 0; v < vertexNum; v++) {
+        // the clique from v can not be larger than its degree
+        if (count( adjacency[v] ) + 1 > getCliqueSize()) {
+            greedyFrom( v, (v < GREEDY_REFINE_START_NUM) );
+        }
+    }
+
+    return getCliqueSize();
+}
+
+bool MaxClique::exactSearch( double timeLimit )
+{
+    if (clique.empty()) {
+        greedySearch();
+    }
+
+    isTimeOut = false;
+    branchCount = 0;
+    deadline = chrono::steady_clock::now()
+        + chrono::duration_cast<chrono::steady_clock::duration>( chrono::duration<double>( timeLimit ) );
+    if (timeLimit <= 0) {
+        deadline = chrono::steady_clock::time_point::max();
+    }
+
+    Bitset candidate( wordNum, 0 );
+    for (int v = 0; v < vertexNum; v++) {
+        set( candidate, v );
+    }
+    currentClique.clear();
+    expand( candidate );
+
+    return !isTimeOut;
+}
+
+void MaxClique::greedyFrom( int start, bool refine )
+{
+    currentClique.clear();
+    currentClique.push_back( start );
+    Bitset &candidate( greedyCandidate );
+    Bitset &unvisited( greedyUnvisited );
+    candidate = adjacency[start];
+
+    while (!isEmpty( candidate )) {
+        int next = first( candidate );  // the one with the largest degree
+        if (refine) {   // the one with the most neighbors among candidates
+            int maxAdjNum = -1;
+            unvisited = candidate;
+            for (int v = next; v >= 0; v = first( unvisited )) {
+                int adjNum = countIntersection( candidate, adjacency[v] );
+                if (adjNum > maxAdjNum) {
+                    maxAdjNum = adjNum;
+                    next = v;
+                }
+                reset( unvisited, v );
+            }
+        }
+
+        currentClique.push_back( next );
+        for (int w = 0; w < wordNum; w++) {
+            candidate[w] &= adjacency[next][w];
+        }
+    }
+
+    if (static_cast<int>(currentClique.size()) > getCliqueSize()) {
+        updateClique( currentClique );
+    }
+}
+
+void MaxClique::colorSort( const Bitset &candidate, int minColor,
+    vector<int> &order, vector<int> &bound ) const
+{
+    Bitset uncolored( candidate );
+    Bitset colorable( wordNum );
+    for (int color = 1; !isEmpty( uncolored ); color++) {
+        colorable = uncolored;
+        for (int v = first( colorable ); v >= 0; v = first( colorable )) {
+            reset( colorable, v );
+            reset( uncolored, v );
+            for (int w = 0; w < wordNum; w++) {
+                colorable[w] &= ~adjacency[v][w];
+            }
+            // vertices with small color can not enlarge the clique
+            if (color >= minColor) {
+                order.push_back( v );
+                bound.push_back( color );
+            }
+        }
+    }
+}
+
+void MaxClique::expand( Bitset &candidate )
+{
+    if (((++branchCount % TIME_CHECK_INTERVAL) == 0)
+        && (chrono::steady_clock::now() > deadline)) {
+        isTimeOut = true;
+    }
+    if (isTimeOut) {
+        return;
+    }
+
+    vector<int> order;
+    vector<int> bound;
+    colorSort( candidate, getCliqueSize() - static_cast<int>(currentClique.size()) + 1, order, bound );
+
+    Bitset newCandidate( wordNum );
+    for (int i = static_cast<int>(order.size()) - 1; i >= 0; i--) {
+        if (static_cast<int>(currentClique.size()) + bound[i] <= getCliqueSize()) {
+            return;
+        }
+
+        int v = order[i];
+        for (int w = 0; w < wordNum; w++) {
+            newCandidate[w] = candidate[w] & adjacency[v][w];
+        }
+
+        currentClique.push_back( v );
+        if (isEmpty( newCandidate )) {
+            if (static_cast<int>(currentClique.size()) > getCliqueSize()) {
+                updateClique( currentClique );
+            }
+        } else {
+            expand( newCandidate );
+        }
+        currentClique.pop_back();
+
+        if (isTimeOut) {
+            return;
+        }
+        reset( candidate, v );
+    }
+}
+
+void MaxClique::updateClique( const Clique &c )
+{
+    clique.resize( c.size() );
+    for (size_t i = 0; i < c.size(); i++) {
+        clique[i] = originIndex[c[i]];
+    }
+}
+
+bool MaxClique::isEmpty( const Bitset &b ) const
+{
+    for (int w = 0; w < wordNum; w++) {
+        if (b[w] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int MaxClique::count( const Bitset &b ) const
+{
+    int n = 0;
+    for (int w = 0; w < wordNum; w++) {
+        n += popCount( b[w] );
+    }
+    return n;
+}
+
+int MaxClique::countIntersection( const Bitset &l, const Bitset &r ) const
+{
+    int n = 0;
+    for (int w = 0; w < wordNum; w++) {
+        n += popCount( l[w] & r[w] );
+    }
+    return n;
+}
+
+int MaxClique::first( const Bitset &b ) const
+{
+    for (int w = 0; w < wordNum; w++) {
+        if (b[w] != 0) {
+            return (w * BITS_PER_WORD + trailingZero( b[w] ));
+        }
+    }
+    return -1;
+}
+
+int MaxClique::popCount( Word w )
+{
+#ifdef _MSC_VER
+    return __popcnt( w );
+#else
+    return __builtin_popcount( w );
+#endif
+}
+
+int MaxClique::trailingZero( Word w )
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward( &index, w );
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz( w );
+#endif
+}
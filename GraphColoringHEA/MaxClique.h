@@ -0,0 +1,96 @@
+/**
+*   usage : 1. construct the MaxClique object with the adjacency list
+*               (or call reset() on an existing one to reuse its buffers for another graph)
+*           2. call greedySearch() for a quick clique
+*           3. [optional] call exactSearch() to improve it to the maximum clique within the time limit
+*           4. call getClique() or getCliqueSize() to get the best clique found
+*
+*   algorithm:
+*           1. greedy: start from each vertex, repeatedly add the candidate with the most
+*               neighbors among the candidates.
+*           2. exact: bitset branch and bound with greedy coloring bound (BBMC),
+*               vertices are renumbered in non-increasing degree order.
+*
+*   note :  1. the clique size is a lower bound of the chromatic number.
+*           2. exactSearch() returns true only if the maximum clique is proved.
+*/
+
+#ifndef MAX_CLIQUE_H
+
+
+#include <vector>
+#include <chrono>
+
+
+class MaxClique
+{
+public:
+    typedef std::vector<int> Clique;
+    typedef std::vector< std::vector<int> > AdjVertexList;
+
+    static const int GREEDY_REFINE_START_NUM = 64;  // start vertices with full greedy selection
+    static const int TIME_CHECK_INTERVAL = 1024;    // branch count between checking time
+
+    MaxClique() : vertexNum( 0 ), wordNum( 0 ), isTimeOut( false ), branchCount( 0 ) {}
+    MaxClique( const AdjVertexList &adjVertexList );
+
+    // switch to another graph and drop the clique found, the buffers keep their capacity
+    void reset( const AdjVertexList &adjVertexList );
+
+    // return the size of the best clique
+    int greedySearch();
+    // return true if the best clique is proved to be maximum within the time limit (in seconds)
+    bool exactSearch( double timeLimit );
+
+    int getCliqueSize() const { return static_cast<int>(clique.size()); }
+    const Clique& getClique() const { return clique; }
+
+private:
+    typedef unsigned Word;
+    typedef std::vector<Word> Bitset;
+
+    static const int BITS_PER_WORD = 32;
+
+    // operations on bitset in renumbered vertex
+    void set( Bitset &b, int v ) const { b[v / BITS_PER_WORD] |= (1U << (v % BITS_PER_WORD)); }
+    void reset( Bitset &b, int v ) const { b[v / BITS_PER_WORD] &= ~(1U << (v % BITS_PER_WORD)); }
+    bool test( const Bitset &b, int v ) const { return ((b[v / BITS_PER_WORD] >> (v % BITS_PER_WORD)) & 1) != 0; }
+    bool isEmpty( const Bitset &b ) const;
+    int count( const Bitset &b ) const;
+    int countIntersection( const Bitset &l, const Bitset &r ) const;
+    int first( const Bitset &b ) const;  // return -1 if it is empty
+
+    static int popCount( Word w );
+    static int trailingZero( Word w );
+
+    // greedy clique from vertex, refine by selecting the best candidate in each step
+    void greedyFrom( int start, bool refine );
+    // assign colors to candidates and keep those which may enlarge the clique
+    void colorSort( const Bitset &candidate, int minColor,
+        std::vector<int> &order, std::vector<int> &bound ) const;
+    void expand( Bitset &candidate );
+    void updateClique( const Clique &c );
+
+    int vertexNum;
+    int wordNum;
+    std::vector<int> originIndex;   // renumbered vertex to the original one
+    std::vector<Bitset> adjacency;  // in renumbered vertex (only the first vertexNum rows are used)
+
+    Clique clique;          // best clique in original vertex
+    Clique currentClique;   // in renumbered vertex
+
+    // buffers reused by reset() and greedyFrom()
+    std::vector< std::pair<int, int> > degreeOrder;
+    std::vector<int> newIndex;
+    Bitset greedyCandidate;
+    Bitset greedyUnvisited;
+
+    // for exact search
+    bool isTimeOut;
+    long long branchCount;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+
+#define MAX_CLIQUE_H
+#endif
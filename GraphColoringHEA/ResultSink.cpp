@@ -0,0 +1,187 @@
+#include "ResultSink.h"
+
+#include <sstream>
+#include <chrono>
+
+using namespace std;
+
+
+ResultSink::ResultSink( const string &csvFileName, const string &slnFileName, int bs )
+    : csvFile( csvFileName, ios::app ),
+    solutionFile( slnFileName, ios::app | ios::binary ), solutionFileName( slnFileName ),
+    batchSize( bs ), isClosed( false ), isFlushRequested( false ), pushedNum( 0 ), writtenNum( 0 )
+{
+    solutionFile.seekp( 0, ios::end );
+    writer = thread( &ResultSink::writeLoop, this );
+}
+
+ResultSink::~ResultSink()
+{
+    {
+        lock_guard<mutex> lock( pendingMutex );
+        isClosed = true;
+    }
+    pendingCondition.notify_one();
+    writer.join();
+}
+
+void ResultSink::appendLine( const string &line )
+{
+    Record record;
+    record.row = line;
+    push( record );
+}
+
+void ResultSink::appendRow( const string &row, const vector<int> &vertexColor, int colorNum )
+{
+    // copy outside the lock
+    Record record;
+    record.row = row;
+    record.vertexColor = vertexColor;
+    record.colorNum = colorNum;
+    record.hasSolution = true;
+    push( record );
+}
+
+void ResultSink::flush()
+{
+    unique_lock<mutex> lock( pendingMutex );
+    long long target = pushedNum;
+    isFlushRequested = true;
+    pendingCondition.notify_one();
+    writtenCondition.wait( lock, [&]() { return (writtenNum >= target); } );
+}
+
+void ResultSink::push( Record &record )
+{
+    bool isBatchFull;
+    {
+        lock_guard<mutex> lock( pendingMutex );
+        pending.push_back( Record() );
+        Record &back( pending.back() );
+        back.row.swap( record.row );
+        back.vertexColor.swap( record.vertexColor );
+        back.colorNum = record.colorNum;
+        back.hasSolution = record.hasSolution;
+        pushedNum++;
+        isBatchFull = (static_cast<int>(pending.size()) >= batchSize);
+    }
+    if (isBatchFull) {
+        pendingCondition.notify_one();
+    }
+}
+
+void ResultSink::writeLoop()
+{
+    // the duration takes a reference, so copy the constant which has no out-of-class definition
+    const chrono::milliseconds flushInterval( static_cast<int>(FLUSH_INTERVAL_MS) );
+
+    vector<Record> batch;
+    unique_lock<mutex> lock( pendingMutex );
+    while (true) {
+        // write the pending rows on timeout even if the batch is not full
+        pendingCondition.wait_for( lock, flushInterval, [&]() {
+            return (isClosed || isFlushRequested
+                || (static_cast<int>(pending.size()) >= batchSize));
+        } );
+
+        bool isLast = isClosed;
+        isFlushRequested = false;
+        batch.swap( pending );
+        long long batchEnd = writtenNum + batch.size();
+
+        // write without holding the lock
+        lock.unlock();
+        writeBatch( batch );
+        batch.clear();
+        lock.lock();
+
+        writtenNum = batchEnd;
+        writtenCondition.notify_all();
+        if (isLast && pending.empty()) {
+            break;
+        }
+    }
+}
+
+void ResultSink::writeBatch( vector<Record> &batch )
+{
+    if (batch.empty()) {
+        return;
+    }
+
+    ostringstream rows;
+    for (vector<Record>::iterator iter = batch.begin(); iter != batch.end(); iter++) {
+        rows << iter->row;
+        if (iter->hasSolution) {
+            rows << solutionFileName << '@' << static_cast<long long>(solutionFile.tellp());
+
+            buffer.clear();
+            unsigned header[2] = { static_cast<unsigned>(iter->vertexColor.size()),
+                static_cast<unsigned>(iter->colorNum) };
+            for (int i = 0; i < 2; i++) {
+                for (int b = 0; b < 32; b += 8) {
+                    buffer.push_back( static_cast<char>((header[i] >> b) & 0xFF) );
+                }
+            }
+            packVertexColor( iter->vertexColor, iter->colorNum, buffer );
+            solutionFile.write( buffer.data(), buffer.size() );
+        }
+        rows << '\n';
+    }
+
+    // one flush for the whole batch
+    solutionFile.flush();
+    csvFile << rows.str();
+    csvFile.flush();
+}
+
+
+int bitWidth( int colorNum )
+{
+    int width = 1;
+    while ((1 << width) < colorNum) {
+        width++;
+    }
+    return width;
+}
+
+void packVertexColor( const vector<int> &vertexColor, int colorNum, string &buf )
+{
+    int width = bitWidth( colorNum );
+    unsigned bits = 0;
+    int bitNum = 0;
+    for (vector<int>::const_iterator iter = vertexColor.begin();
+        iter != vertexColor.end(); iter++) {
+        bits |= (static_cast<unsigned>(*iter) << bitNum);
+        for (bitNum += width; bitNum >= 8; bitNum -= 8) {
+            buf.push_back( static_cast<char>(bits & 0xFF) );
+            bits >>= 8;
+        }
+    }
+    if (bitNum > 0) {
+        buf.push_back( static_cast<char>(bits & 0xFF) );
+    }
+}
+
+size_t unpackVertexColor( const char *data, int vertexNum, int colorNum, vector<int> &vertexColor )
+{
+    int width = bitWidth( colorNum );
+    unsigned mask = (1U << width) - 1;
+    unsigned bits = 0;
+    int bitNum = 0;
+    size_t byteNum = 0;
+
+    vertexColor.resize( vertexNum );
+    for (int v = 0; v < vertexNum; v++) {
+        while (bitNum < width) {
+            bits |= (static_cast<unsigned>(static_cast<unsigned char>(data[byteNum++])) << bitNum);
+            bitNum += 8;
+        }
+        vertexColor[v] = static_cast<int>(bits & mask);
+        bits >>= width;
+        bitNum -= width;
+    }
+
+    return byteNum;
+}
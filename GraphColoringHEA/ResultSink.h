@@ -0,0 +1,89 @@
+/**
+*   usage : 1. construct the ResultSink object with the csv file and the solution file
+*           2. call appendLine() or appendRow() from any thread
+*           3. call flush() or destruct it to write all pending rows
+*
+*   note :  1. rows are queued and written by a background thread in batches,
+*               the caller never waits for file I/O.
+*           2. the solution of each row is bit-packed into the binary solution file,
+*               and the csv row ends with "<solution file>@<byte offset>".
+*           3. a record in the solution file is [vertexNum][colorNum][packed colors],
+*               where the numbers are 32-bit little-endian and each color takes
+*               bitWidth( colorNum ) bits (see packVertexColor()).
+*/
+
+#ifndef RESULT_SINK_H
+
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+class ResultSink
+{
+public:
+    static const int DEFAULT_BATCH_SIZE = 64;
+    static const int FLUSH_INTERVAL_MS = 1000;  // write pending rows at least this often
+
+    ResultSink( const std::string &csvFileName, const std::string &solutionFileName,
+        int batchSize = DEFAULT_BATCH_SIZE );
+    ~ResultSink();
+
+    // append a line to the csv file as is
+    void appendLine( const std::string &line );
+    // append a row which ends with the reference to the solution
+    void appendRow( const std::string &row, const std::vector<int> &vertexColor, int colorNum );
+    // block until all pending rows are written
+    void flush();
+
+private:
+    struct Record
+    {
+    public:
+        Record() : colorNum( 0 ), hasSolution( false ) {}
+
+        std::string row;
+        std::vector<int> vertexColor;
+        int colorNum;
+        bool hasSolution;
+    };
+
+    ResultSink( const ResultSink & );
+    ResultSink& operator=(const ResultSink &);
+
+    void push( Record &record );
+    void writeLoop();
+    void writeBatch( std::vector<Record> &batch );
+
+    std::ofstream csvFile;
+    std::ofstream solutionFile;
+    std::string solutionFileName;
+    std::string buffer;     // reused for packing solutions
+
+    int batchSize;
+    std::vector<Record> pending;
+    bool isClosed;
+    bool isFlushRequested;
+    long long pushedNum;
+    long long writtenNum;
+    std::mutex pendingMutex;
+    std::condition_variable pendingCondition;   // notify the writer
+    std::condition_variable writtenCondition;   // notify flush()
+    std::thread writer;
+};
+
+
+// bits to store a color in [0, colorNum)
+int bitWidth( int colorNum );
+// append the packed colors to buf
+void packVertexColor( const std::vector<int> &vertexColor, int colorNum, std::string &buf );
+// read vertexNum colors from the packed data, return the number of bytes consumed
+size_t unpackVertexColor( const char *data, int vertexNum, int colorNum, std::vector<int> &vertexColor );
+
+
+#define RESULT_SINK_H
+#endif
@@ -4,19 +4,35 @@ using namespace std;
 
 
 
-int main()
+// island mode:
+//     GraphColoringHEA coordinator <address> <workerNum> <inst>
+//     GraphColoringHEA worker <address> <inst>
+int main( int argc, char *argv[] )
 {
-    ofstream csvFile( LOG_FILE, ios::app );
-    GraphColoring::initResultSheet( csvFile );
+    if (argc > 1) {
+        string mode( argv[1] );
+        if ((mode == "coordinator") && (argc > 4)) {
+            run_coordinator( argv[2], atoi( argv[3] ), atoi( argv[4] ) );
+            return 0;
+        } else if ((mode == "worker") && (argc > 3)) {
+            run_worker( argv[2], atoi( argv[3] ) );
+            return 0;
+        }
+        cout << "usage: " << argv[0] << " [coordinator <address> <workerNum> <inst> | worker <address> <inst>]" << endl;
+        return 1;
+    }
+
+    ResultSink logSink( LOG_FILE, SOLUTION_FILE );
+    GraphColoring::initResultSheet( logSink );
 
     for (int inst = 0; inst < 7; inst++) {
-        run( inst, csvFile );
-        //run_tabu( inst, csvFile );
+        // race the tabu tenure configurations, then solve with the winner
+        run( inst, logSink, run_tabu( inst, logSink ).front() );
     }
-    //run( 6, csvFile );
-    //run_tabu( 6, csvFile );
+    //run( 6, logSink );
+    //run_tabu( 6, logSink );
 
-    csvFile.close();
+    logSink.flush();
     system( "pause" );
     return 0;
 }
\ No newline at end of file
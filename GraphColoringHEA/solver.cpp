@@ -4,7 +4,7 @@
 using namespace std;
 
 
-void run( int inst, ofstream &logFile )
+void run( int inst, ResultSink &logSink, const TabuConfig &config )
 {
     const string &instName = INSTANCE[inst];
     GraphColoring::AdjVertexList adjVertexList( readInstance( instName ) );
@@ -14,24 +14,31 @@ void run( int inst, ofstream &logFile )
 
     //int tabuTenureBase = static_cast<int>(sqrt( colorNum ));
     int tabuTenureBase = 0;
-    int tabuTenureAmp = 9;
     int maxGenerationCount = static_cast<int>(2E4);
     int maxIterCount = static_cast<int>(1E5);
     int populationSize = 1;
     int mutateIndividualNum = populationSize / 4;
+    double poolQualityWeight = 0.6;
+
+    // skip all runs if there is no legal coloring
+    int lowerBound = GraphColoring::computeLowerBound( adjVertexList, CLIQUE_TIME_LIMIT );
+    if (colorNum < lowerBound) {
+        return;
+    }
 
     for (int runTime = 16; runTime > 0; runTime--) {
         GraphColoring gc( adjVertexList, colorNum );
+        gc.setLowerBound( lowerBound );
 
-        gc.init( tabuTenureBase, tabuTenureAmp, maxGenerationCount, maxIterCount,
-            populationSize, mutateIndividualNum );
+        gc.init( tabuTenureBase, config.tabuTenureAmp, maxGenerationCount, maxIterCount,
+            populationSize, mutateIndividualNum, poolQualityWeight, config.tabuTenureAdaptPeriod );
         gc.solve();
         //gc.print();
-        gc.appendResultToSheet( instName, logFile );
+        gc.appendResultToSheet( instName, logSink );
     }
 }
 
-void run_tabu( int inst, ofstream &logFile )
+vector<TabuConfig> run_tabu( int inst, ResultSink &logSink )
 {
     const string &instName = INSTANCE[inst];
     GraphColoring::AdjVertexList adjVertexList( readInstance( instName ) );
@@ -39,25 +46,262 @@ void run_tabu( int inst, ofstream &logFile )
     int colorNum = readOptima( inst );
     int vertexNum = adjVertexList.size();
 
-    //int tabuTenureBase = static_cast<int>(sqrt( colorNum ));
     int tabuTenureBase = 0;
-    int tabuTenureAmp = 9;
     int maxGenerationCount = 0;
     int maxIterCount = static_cast<int>(2E9);
     int populationSize = 1;
     int mutateIndividualNum = populationSize / 4;
+    double poolQualityWeight = 0.6;
+
+    // candidate configurations with fixed and adaptive tenure
+    vector<TabuConfig> configs;
+    for (int tabuTenureAmp = 6; tabuTenureAmp <= 16; tabuTenureAmp++) {
+        configs.push_back( TabuConfig( tabuTenureAmp, 0 ) );
+        configs.push_back( TabuConfig( tabuTenureAmp, 10 * vertexNum ) );
+    }
 
-    for (tabuTenureAmp = 6; tabuTenureAmp <= 16; tabuTenureAmp++) {
-        for (int runTime = 16; runTime > 0; runTime--) {
-            GraphColoring gc( adjVertexList, colorNum );
+    vector<int> alive;
+    for (int i = 0; i < static_cast<int>(configs.size()); i++) {
+        alive.push_back( i );
+    }
+
+    // costs[round][config] is the iteration count to reach no conflict
+    vector< vector<double> > costs;
+    int threadNum = max( 1U, thread::hardware_concurrency() );
+    int raceSeed = static_cast<int>(time( 0 ));
+    chrono::steady_clock::time_point raceStartTime = chrono::steady_clock::now();
+    for (int round = 0; (round < RACE_MAX_ROUND) && (alive.size() > 1); round++) {
+        vector<GraphColoring> results;
+        results.reserve( alive.size() );
+        for (size_t i = 0; i < alive.size(); i++) {
+            results.push_back( GraphColoring( adjVertexList, colorNum ) );
+        }
 
-            gc.init( tabuTenureBase, tabuTenureAmp, maxGenerationCount, maxIterCount,
-                populationSize, mutateIndividualNum );
-            gc.solve();
-            //gc.print();
-            gc.appendResultToSheet( instName, logFile );
+        // run all surviving configurations concurrently
+        atomic<int> next( 0 );
+        vector<thread> workers;
+        for (int t = min( threadNum, static_cast<int>(alive.size()) ); t > 0; t--) {
+            workers.push_back( thread( [&]() {
+                for (int i = next++; i < static_cast<int>(alive.size()); i = next++) {
+                    const TabuConfig &config( configs[alive[i]] );
+                    // each run gets its own seed in the thread which runs it
+                    results[i].setRandSeed( raceSeed + round * static_cast<int>(configs.size()) + alive[i] );
+                    results[i].init( tabuTenureBase, config.tabuTenureAmp,
+                        maxGenerationCount, maxIterCount, populationSize,
+                        mutateIndividualNum, poolQualityWeight, config.tabuTenureAdaptPeriod );
+                    results[i].solve();
+                    results[i].appendResultToSheet( instName, logSink );
+                }
+            } ) );
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+
+        // unsolved runs are worse than any solved one
+        costs.push_back( vector<double>( configs.size(), 0 ) );
+        for (size_t i = 0; i < alive.size(); i++) {
+            const GraphColoring &gc( results[i] );
+            costs[round][alive[i]] = static_cast<double>(gc.getIterCount())
+                + static_cast<double>(maxIterCount) * gc.getOptima().conflictEdgeNum;
+        }
+
+        if (round + 1 >= RACE_MIN_ROUND) {
+            alive = raceElimination( costs, alive );
         }
     }
+
+    // order the survivors by mean cost (the first one is the winner)
+    int roundNum = costs.size();
+    vector<double> meanCost( configs.size(), 0 );
+    vector<int> unsolvedNum( configs.size(), 0 );
+    for (size_t i = 0; i < alive.size(); i++) {
+        for (int r = 0; r < roundNum; r++) {
+            meanCost[alive[i]] += costs[r][alive[i]] / roundNum;
+            if (costs[r][alive[i]] >= maxIterCount) {
+                unsolvedNum[alive[i]]++;
+            }
+        }
+    }
+    sort( alive.begin(), alive.end(), [&]( int l, int r ) { return (meanCost[l] < meanCost[r]); } );
+
+    vector<TabuConfig> survivors;
+    ostringstream survivorList;
+    for (size_t i = 0; i < alive.size(); i++) {
+        const TabuConfig &config( configs[alive[i]] );
+        survivors.push_back( config );
+        survivorList << "TA=" << config.tabuTenureAmp << "|TP=" << config.tabuTenureAdaptPeriod << ' ';
+    }
+
+    // summary row in the columns of the result sheet
+    ostringstream row;
+    row << Timer::getLocalTime() << ", "
+        << instName << ", "
+        << "FRace(CN=" << configs.size() << "|RN=" << roundNum << "|SN=" << alive.size() << "), "
+        << raceSeed << ", "
+        << chrono::duration<double>( chrono::steady_clock::now() - raceStartTime ).count() << ", "
+        << static_cast<long long>(meanCost[alive[0]]) << ", "
+        << roundNum << ", "
+        << unsolvedNum[alive[0]] << ", "
+        << survivorList.str();
+    logSink.appendLine( row.str() );
+    cout << "[Race] " << instName << " (" << colorNum << ") " << survivorList.str() << endl;
+
+    return survivors;
+}
+
+void run_descent( int inst, ResultSink &logSink )
+{
+    const string &instName = INSTANCE[inst];
+    GraphColoring::AdjVertexList adjVertexList( readInstance( instName ) );
+
+    int colorNum = readOptima( inst );
+
+    int tabuTenureBase = 0;
+    int tabuTenureAmp = 9;
+    int maxGenerationCount = static_cast<int>(2E4);
+    int maxIterCount = static_cast<int>(1E5);
+    int populationSize = 10;
+    int mutateIndividualNum = populationSize / 4;
+
+    int lowerBound = GraphColoring::computeLowerBound( adjVertexList, CLIQUE_TIME_LIMIT );
+
+    // stop when it fails or no less color is possible
+    while (colorNum >= lowerBound) {
+        GraphColoring gc( adjVertexList, colorNum );
+        gc.setLowerBound( lowerBound );
+
+        gc.init( tabuTenureBase, tabuTenureAmp, maxGenerationCount, maxIterCount,
+            populationSize, mutateIndividualNum );
+        gc.solve();
+        gc.appendResultToSheet( instName, logSink );
+
+        if ((gc.getOptima().conflictEdgeNum > 0) || gc.isOptimal()) {
+            break;
+        }
+        colorNum = gc.getUsedColorNum() - 1;
+    }
+}
+
+void run_coordinator( const string &address, int workerNum, int inst )
+{
+    const string &instName = INSTANCE[inst];
+    GraphColoring::AdjVertexList adjVertexList( readInstance( instName ) );
+
+    int colorNum = readOptima( inst );
+
+    IslandCoordinator coordinator( address, colorNum, static_cast<int>(adjVertexList.size()) );
+    GraphColoring::Output optima( coordinator.run( workerNum ) );
+
+    // verify the coloring from workers
+    GraphColoring gc( adjVertexList, colorNum );
+    if (optima.vertexColor.empty()) {
+        cout << "[NoResult] " << instName << endl;
+    } else {
+        if (gc.check( optima.vertexColor ) != optima.conflictEdgeNum) {
+            cout << "[LogicError] ";
+        }
+        cout << instName << " (" << colorNum << ") " << optima.conflictEdgeNum << endl;
+    }
+}
+
+void run_worker( const string &address, int inst )
+{
+    const string &instName = INSTANCE[inst];
+    GraphColoring::AdjVertexList adjVertexList( readInstance( instName ) );
+
+    int colorNum = readOptima( inst );
+
+    int tabuTenureBase = 0;
+    int tabuTenureAmp = 9;
+    int maxGenerationCount = static_cast<int>(2E4);
+    int maxIterCount = static_cast<int>(1E5);
+    int populationSize = 10;
+    int mutateIndividualNum = populationSize / 4;
+
+    IslandWorker worker( address );
+    if (!worker.isConnected()) {
+        cout << "[ConnectionError] " << address << endl;
+        return;
+    }
+
+    GraphColoring gc( adjVertexList, colorNum );
+    worker.run( gc, tabuTenureBase, tabuTenureAmp, maxGenerationCount, maxIterCount,
+        populationSize, mutateIndividualNum );
+    gc.print();
+}
+
+vector<int> raceElimination( const vector< vector<double> > &costs, const vector<int> &alive )
+{
+    // upper z value for 95% confidence level (one-sided for the chi-square test)
+    const double Z = 1.645;
+    // z value for the two-sided post-hoc comparison at the same level
+    const double TWO_SIDED_Z = 1.96;
+
+    int n = costs.size();           // number of blocks (rounds)
+    int m = alive.size();           // number of treatments (configurations)
+    if ((m < 2) || (n < 2)) {
+        return alive;
+    }
+
+    // rank configurations in each round (average rank for ties)
+    vector<double> rankSum( m, 0 );
+    double rankSquareSum = 0;
+    for (int r = 0; r < n; r++) {
+        for (int i = 0; i < m; i++) {
+            double cost = costs[r][alive[i]];
+            int less = 0;
+            int equal = 0;
+            for (int j = 0; j < m; j++) {
+                double c = costs[r][alive[j]];
+                if (c < cost) {
+                    less++;
+                } else if (c == cost) {
+                    equal++;
+                }
+            }
+            double rank = less + (equal + 1) / 2.0;
+            rankSum[i] += rank;
+            rankSquareSum += rank * rank;
+        }
+    }
+
+    // Friedman statistic against chi-square quantile (Wilson-Hilferty approximation)
+    double expectedRankSum = n * (m + 1) / 2.0;
+    double deviation = 0;
+    double rankSumSquare = 0;
+    for (int i = 0; i < m; i++) {
+        deviation += (rankSum[i] - expectedRankSum) * (rankSum[i] - expectedRankSum);
+        rankSumSquare += rankSum[i] * rankSum[i];
+    }
+    double denominator = rankSquareSum - n * m * (m + 1) * (m + 1) / 4.0;
+    if (denominator <= 0) {   // all tied
+        return alive;
+    }
+    double statistic = (m - 1) * deviation / denominator;
+    double df = m - 1;
+    double quantile = df * pow( 1 - 2 / (9 * df) + Z * sqrt( 2 / (9 * df) ), 3 );
+    if (statistic <= quantile) {
+        return alive;
+    }
+
+    // post-hoc test: drop configurations far from the best rank sum
+    double bestRankSum = *min_element( rankSum.begin(), rankSum.end() );
+    // t quantile with (n - 1)(m - 1) degrees of freedom by Cornish-Fisher expansion
+    double tdf = (n - 1) * (m - 1);
+    double z2 = TWO_SIDED_Z * TWO_SIDED_Z;
+    double t = TWO_SIDED_Z + TWO_SIDED_Z * (z2 + 1) / (4 * tdf)
+        + TWO_SIDED_Z * ((5 * z2 + 16) * z2 + 3) / (96 * tdf * tdf);
+    double criticalDiff = t * sqrt( 2 * n * (rankSquareSum - rankSumSquare / n)
+        / ((n - 1) * (m - 1)) );
+    vector<int> survivors;
+    for (int i = 0; i < m; i++) {
+        if (rankSum[i] - bestRankSum <= criticalDiff) {
+            survivors.push_back( alive[i] );
+        }
+    }
+
+    return survivors;
 }
 
 
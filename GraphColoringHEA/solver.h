@@ -1,7 +1,19 @@
 /**
 *   usage : 1. set algorithm arguments in run()
+*           2. call run_tabu() to race tabu tenure configurations on an instance,
+*               and pass the winner to run() (see main())
+*           3. call run_descent() to decrease the color number until it fails or reaches the clique bound
+*           4. call run_coordinator() in one process and run_worker() in others for island mode
+*               (see main() for the command line)
 *
-*   note :  1.
+*   note :  1. run_tabu() is an F-race: each round runs all surviving configurations
+*               concurrently with a distinct random seed for each run (set in the thread of the run
+*               and logged as RandSeed), and the configurations which are significantly worse
+*               by Friedman test are dropped after RACE_MIN_ROUND.
+*           2. run_tabu() returns the survivors ordered by mean cost and appends a summary row
+*               "FRace(CN=configNum|RN=roundNum|SN=survivorNum)" to the result sheet,
+*               whose IterCount is the mean cost of the winner, GenerationCount is the round number,
+*               Optima is the number of rounds the winner left unsolved and Solution lists the survivors.
 */
 
 #ifndef SOLVER_H
@@ -10,13 +22,27 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sstream>
 
 #include "GraphColoring.h"
+#include "Island.h"
 
 
 const int MAX_BUF_LEN = 1000;   // max length for char array buf
 
+const double CLIQUE_TIME_LIMIT = 10;    // in seconds for exact max clique search
+
+const int RACE_MIN_ROUND = 5;   // rounds before dropping any configuration
+const int RACE_MAX_ROUND = 16;  // rounds before the race stops
+
 const std::string LOG_FILE = "log.csv";
+const std::string SOLUTION_FILE = "log.sln";    // packed solutions referenced by LOG_FILE
 const std::string INST_DIR = "../instance/";
 const std::string OPTIMA_FILE = "optima.txt";
 const int INSTANCE_NUM = 12;
@@ -37,8 +63,24 @@ const std::string INSTANCE[INSTANCE_NUM] = {
 
 
 
-void run( int inst, std::ofstream &logFile );
-void run_tabu( int inst, std::ofstream &logFile );
+struct TabuConfig
+{
+    TabuConfig( int amp, int period ) : tabuTenureAmp( amp ), tabuTenureAdaptPeriod( period ) {}
+
+    int tabuTenureAmp;
+    int tabuTenureAdaptPeriod;
+};
+
+// solve with the tabu tenure configuration, such as the winner of run_tabu()
+void run( int inst, ResultSink &logSink, const TabuConfig &config = TabuConfig( 9, 0 ) );
+// return the surviving configurations of the race, the best first
+std::vector<TabuConfig> run_tabu( int inst, ResultSink &logSink );
+void run_descent( int inst, ResultSink &logSink );
+void run_coordinator( const std::string &address, int workerNum, int inst );
+void run_worker( const std::string &address, int inst );
+// return indices of the configurations which survive the Friedman test
+std::vector<int> raceElimination( const std::vector< std::vector<double> > &costs,
+    const std::vector<int> &alive );
 GraphColoring::AdjVertexList readInstance( const std::string &fileName );
 int readOptima( int inst );
 